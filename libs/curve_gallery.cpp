@@ -1,5 +1,7 @@
 #include "curve_gallery.h"
 
+#include <algorithm>
+
 #include "imgui/curve.h"
 
 namespace io {
@@ -40,16 +42,86 @@ Curve::Curve() : m_points(4) {}
 
 Curve::Curve(points_t points) : m_points(points) {}
 
-void Curve::load(points_t points) { m_points = points; }
+void Curve::load(points_t points) {
+  m_points = points;
+  m_segmentsStale = true;
+}
 
-ImVec2 *Curve::data() { return m_points.data(); }
+ImVec2 *Curve::data() {
+  // may be edited through it
+  m_segmentsStale = true;
+  return m_points.data();
+}
 
 float Curve::evaluate(float t) const {
   return ImGui::CurveValue(t, size(), data());
 }
 
+// Expands ImGui::spline (dim 1) for each segment: segment k runs from point
+// k - 1 to k and blends the y of points k - 2 to k + 1, clamped to the ends.
+void Curve::buildSegments() const {
+  static signed char const coefs[16] = {-1, 2, -1, 0, 3, -5, 0, 2,
+                                        -3, 4, 1,  0, 1, -1, 0, 0};
+  int const num = size();
+
+  m_segments.assign(num * 4, 0.f);
+  for (int k = 1; k < num; ++k) {
+    float *c = &m_segments[k * 4];
+    for (int i = 0; i < 4; ++i) {
+      int kn = std::min(std::max(k + i - 2, 0), num - 1);
+      float y = m_points[kn].y;
+      for (int j = 0; j < 4; ++j)
+        c[j] += 0.5f * coefs[4 * i + j] * y;
+    }
+  }
+  m_segmentsStale = false;
+}
+
+float Curve::evaluateSegment(int k, float t) const {
+  // before the first key spline would read ahead of the points, which
+  // came out as the first point
+  if (k == 0)
+    return m_points[0].y;
+
+  float const x0 = m_points[k - 1].x;
+  float const h = (t - x0) / (m_points[k].x - x0);
+  float const *c = &m_segments[k * 4];
+  return ((c[0] * h + c[1]) * h + c[2]) * h + c[3];
+}
+
 float Curve::evaluateSmooth(float t) const {
-  return ImGui::CurveValueSmooth(t, size(), data());
+  if (size() < 2)
+    return 0.f;
+  if (t < 0)
+    return m_points[0].y;
+  if (m_segmentsStale)
+    buildSegments();
+
+  int k = 0;
+  while (k < size() - 1 && m_points[k].x < t)
+    ++k;
+
+  return evaluateSegment(k, t);
+}
+
+MemoizeFunction Curve::memoizeSmooth(int steps) const {
+  values_t values(steps, 0.f);
+  if (size() < 2)
+    return {values};
+  if (m_segmentsStale)
+    buildSegments();
+
+  // the first key at or past t can only move forward as t grows
+  float delta = 1.f / steps;
+  int k = 0;
+  for (int i = 0; i < steps; ++i) {
+    float t = i * delta;
+    while (k < size() - 1 && m_points[k].x < t)
+      ++k;
+    values[i] = evaluateSegment(k, t);
+  }
+
+  return {values};
 }
 
 ImVec2 const *Curve::data() const { return m_points.data(); }
@@ -73,10 +145,7 @@ int CurveGallery::create(int numberOfPoints) {
 
   data.curve = Curve(points);
 
-  data.memoized = io::memoizeFunction(numberOfPoints, [&](float t) {
-    // return curve.evaluate(t);
-    return data.curve.evaluateSmooth(t);
-  });
+  data.memoized = data.curve.memoizeSmooth(numberOfPoints);
 
   int index = m_curvesData.size();
   m_curvesData.push_back(data);
@@ -102,10 +171,7 @@ int CurveGallery::create(std::string title, int numberOfPoints) {
 
   data.curve = Curve(points);
 
-  data.memoized = io::memoizeFunction(numberOfPoints, [&](float t) {
-    // return curve.evaluate(t);
-    return data.curve.evaluateSmooth(t);
-  });
+  data.memoized = data.curve.memoizeSmooth(numberOfPoints);
 
   int index = m_curvesData.size();
   m_curvesData.push_back(data);
@@ -164,11 +230,7 @@ void Gallery(io::CurveGallery &gallery) {
 
     if (changed) {
       // update memoized
-      auto &curve = data.curve;
-      data.memoized = io::memoizeFunction(steps, [&](float t) {
-        // return curve.evaluate(t);
-        return curve.evaluateSmooth(t);
-      });
+      data.memoized = data.curve.memoizeSmooth(steps);
     }
 
     ImGui::PlotHistogram(data.title.c_str(), data.memoized.data(),
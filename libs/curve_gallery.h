@@ -29,6 +29,10 @@ private:
 MemoizeFunction memoizeFunction(int steps,
                                 std::function<float(float)> const &func);
 
+// The smooth evaluation keeps the cubic of every spline segment, rebuilt
+// the first time it is needed after the points changed (load, or editing
+// them through the non-const data()), so evaluating is a key search and one
+// polynomial with no allocation.
 class Curve {
 public:
   using points_t = std::vector<ImVec2>;
@@ -43,11 +47,22 @@ public:
   float evaluate(float t) const;
   float evaluateSmooth(float t) const;
 
+  // same as memoizeFunction over evaluateSmooth, walking the segments
+  // once instead of searching them for every bucket
+  MemoizeFunction memoizeSmooth(int steps) const;
+
   ImVec2 const *data() const;
   int size() const;
 
+private:
+  void buildSegments() const;
+  float evaluateSegment(int k, float t) const;
+
 private:
   points_t m_points;
+  // h^3, h^2, h, 1 coefficients of the segment ending at each point
+  mutable std::vector<float> m_segments;
+  mutable bool m_segmentsStale = true;
 };
 
 class CurveGallery {
@@ -266,13 +266,34 @@ GLenum givr::getBufferUsageType(BufferUsageType const &d) {
 //------------------------------------------------------------------------------
 
 namespace givr {
+    DrawZoneCallback drawZoneCallback = nullptr;
+
+    std::size_t instanceStride(InstancedRenderContext const &ctx) {
+        std::size_t floats = 0;
+        for (GLint size : ctx.instanceAttributes) {
+            floats += size;
+        }
+        return floats * sizeof(float);
+    }
+
+    void bindInstanceAttributes(InstancedRenderContext &ctx) {
+        // per instance attributes are packed back to back in each instance
+        InstanceRing &instances = *ctx.instances;
+        glBindBuffer(GL_ARRAY_BUFFER, instances);
+        std::size_t offset = instances.offset();
+        for (std::uint16_t i = 0; i < ctx.instanceAttributes.size(); ++i) {
+            GLint size = ctx.instanceAttributes[i];
+            glVertexAttribPointer(i, size, GL_FLOAT, GL_FALSE, instances.stride(), (GLvoid*)offset);
+            offset += size * sizeof(float);
+        }
+    }
+
     void allocateBuffers(InstancedRenderContext &ctx) {
         ctx.vao = std::make_unique<VertexArray>();
         ctx.vao->alloc();
 
         // Map - but don't upload framing data.
-        ctx.modelTransformsBuffer = std::make_unique<Buffer>();
-        ctx.modelTransformsBuffer->alloc();
+        ctx.instances = std::make_unique<InstanceRing>(instanceStride(ctx));
 
         // Map - but don't upload indices data
         std::unique_ptr<Buffer> indices = std::make_unique<Buffer>();
@@ -305,10 +326,8 @@ namespace givr {
         ctx.vao->bind();
 
         // Upload framing data.
-        ctx.modelTransformsBuffer->bind(GL_ARRAY_BUFFER);
-        auto vec4Size = sizeof(mat4f)/4;
-        for (std::uint16_t i = 0; i < 4; ++i) {
-            glVertexAttribPointer(vaIndex, 4, GL_FLOAT, GL_FALSE, sizeof(mat4f), (GLvoid*)(i*vec4Size));
+        bindInstanceAttributes(ctx);
+        for (std::uint16_t i = 0; i < ctx.instanceAttributes.size(); ++i) {
             glEnableVertexAttribArray(vaIndex);
             glVertexAttribDivisor(vaIndex, 1);
             ++vaIndex;
@@ -511,7 +530,7 @@ template<typename ColorSrc>
 using pirc = givr::style::T_PhongInstancedRenderContext<ColorSrc>;
 using namespace givr::style;
 
-std::string givr::style::phongVertexSource(std::string modelSource, bool usingTexture) {
+std::string givr::style::phongVertexSource(std::string modelSource, bool usingTexture, std::string modelSetup) {
     return
         "#version 330 core\n" +
         std::string(usingTexture ? "#define USING_TEXTURE\n" : "") +
@@ -536,6 +555,9 @@ std::string givr::style::phongVertexSource(std::string modelSource, bool usingTe
         out vec3 geomColour;
 
         void main(){
+        )shader") +
+        modelSetup +
+        std::string(R"shader(
             mat4 mv = view * model;
             mat4 mvp = projection * mv;
             gl_Position = mvp * vec4(position, 1.0);
@@ -705,6 +727,34 @@ std::string givr::style::phongFragmentSource(bool usingTexture) {
 // END phong.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start framed_phong.cpp
+//------------------------------------------------------------------------------
+
+std::string givr::style::framedPhongVertexSource() {
+    // instance attributes are bound in order ahead of the mesh attributes,
+    // the phong source then declares model as a plain global filled in here
+    return phongVertexSource(
+        std::string(R"shader(
+        layout(location = 0) in vec3 instancePosition;
+        layout(location = 1) in vec3 instanceVelocity;
+        layout(location = 2) in vec3 instanceForce;
+        uniform vec3 upDirection;
+        )shader"),
+        false,
+        std::string(R"shader(
+            vec3 T = normalize(instanceVelocity); // tangent vector
+            vec3 B = normalize(cross(normalize(upDirection + instanceForce), T));
+            vec3 N = normalize(cross(B, T));
+            B = normalize(cross(T, N)); // make orthonormal
+            model = mat4(vec4(B, 0.0), vec4(N, 0.0), vec4(T, 0.0), vec4(instancePosition, 1.0));
+        )shader")
+    );
+}
+//------------------------------------------------------------------------------
+// END framed_phong.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start lines.cpp
 //------------------------------------------------------------------------------
@@ -1063,121 +1113,173 @@ TriangleGeometry::Data givr::geometry::generateGeometry(TriangleGeometry const &
 //------------------------------------------------------------------------------
 // Start mesh.cpp
 //------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
-#include <unordered_map>
 #include <tuple>
 
-struct index_pair {
-    unsigned int a, b;
-
-    bool operator==(const index_pair& rh) const {
-        return a == rh.a && b == rh.b;
-    }
-
-    bool operator<(index_pair right_hand) {
-        return (a < right_hand.a) ? true : b < right_hand.b;
-    }
-};
-
-namespace std {
-    template<>
-    struct hash<index_pair> {
-        size_t operator()(const index_pair &key) const {
-            return size_t(key.a << 16) | size_t(key.b);
-        }
-    };
-};
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GIVR_MESH_CACHE_MMAP 1
+#endif
 
 namespace givr {
 namespace geometry {
 
-    template<typename V1, typename V2>
-    std::tuple<std::vector<unsigned int>, V1, V2> two_index_unifier(
-        const std::vector<unsigned int> &indices_A, const V1 &data_A, size_t components_A,
-        const std::vector<unsigned int> &indices_B, const V2 &data_B, size_t components_B)
-    {
-
-        std::vector<unsigned int> unified_indices;
-        V1 unified_dataA;
-        V2 unified_dataB;
-        std::unordered_map<index_pair, unsigned int> index_map;
-
-        for (std::size_t i = 0; i < indices_A.size(); i++) {
-            if (index_map.find({ indices_A[i], indices_B[i] }) == index_map.end()) {
-                index_map[{indices_A[i], indices_B[i]}] = unified_dataA.size()/components_A;
-                unified_indices.push_back(unified_dataA.size()/components_A);
+    // The unified mesh is cached next to the OBJ (<file>.meshcache) so later
+    // runs skip tinyobj and the unifiers. The cache is the header below and
+    // then the vertices, normals, uvs and indices back to back, in native
+    // byte order; it's only used if the version, byte order and the size
+    // and modification time of the OBJ it came from all match.
+    constexpr char mesh_cache_magic[8] = "GIVRMSH";
+    constexpr std::uint32_t mesh_cache_version = 1;
+    constexpr std::uint32_t mesh_cache_byte_order = 0x01020304;
+
+    struct mesh_cache_header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        std::uint64_t source_size;
+        std::int64_t source_time;
+        std::uint64_t vertex_count; // floats
+        std::uint64_t normal_count;
+        std::uint64_t uv_count;
+        std::uint64_t index_count;
+    };
 
-                for (std::size_t j = 0; j < components_A; j++)
-                    unified_dataA.push_back(data_A[indices_A[i]*components_A + j]);
+    static std::string mesh_cache_name(const char *file_name) {
+        return std::string(file_name) + ".meshcache";
+    }
 
-                for (std::size_t j = 0; j < components_B; j++)
-                    unified_dataB.push_back(data_B[indices_B[i]*components_B + j]);
-            }
-            else {
-                unified_indices.push_back(index_map[{indices_A[i], indices_B[i]}]);
-            }
-        }
+    // size and modification time of the OBJ, false if it can't be read
+    static bool mesh_source_key(const char *file_name, std::uint64_t &size, std::int64_t &time) {
+        std::error_code error;
+        size = std::filesystem::file_size(file_name, error);
+        if (error) return false;
+        time = std::filesystem::last_write_time(file_name, error).time_since_epoch().count();
+        return !error;
+    }
 
-        return { unified_indices, unified_dataA, unified_dataB };
+    static std::size_t mesh_cache_payload(const mesh_cache_header &header) {
+        return (header.vertex_count + header.normal_count + header.uv_count) * sizeof(float) +
+               header.index_count * sizeof(std::uint32_t);
     }
 
+    // fills data from the cache in bytes, false if it doesn't belong to the source
+    static bool read_mesh_cache(const char *bytes, std::size_t length,
+                         std::uint64_t source_size, std::int64_t source_time,
+                         MeshGeometry::Data &data) {
+        mesh_cache_header header;
+        if (length < sizeof(header)) return false;
+        std::memcpy(&header, bytes, sizeof(header));
+
+        if (std::memcmp(header.magic, mesh_cache_magic, sizeof(header.magic)) != 0 ||
+            header.version != mesh_cache_version ||
+            header.byte_order != mesh_cache_byte_order ||
+            header.source_size != source_size ||
+            header.source_time != source_time ||
+            length != sizeof(header) + mesh_cache_payload(header))
+            return false;
+
+        const char *at = bytes + sizeof(header);
+        auto read = [&at](auto &values, std::uint64_t count) {
+            using value_t = typename std::decay_t<decltype(values)>::value_type;
+            values.resize(count);
+            std::memcpy(values.data(), at, count * sizeof(value_t));
+            at += count * sizeof(value_t);
+        };
+        read(data.vertices, header.vertex_count);
+        read(data.normals, header.normal_count);
+        read(data.uvs, header.uv_count);
+        read(data.indices, header.index_count);
+        return true;
+    }
 
-    template<typename V1, typename V2, typename V3>
-    std::tuple<std::vector<unsigned int>, V1, V2, V3> three_index_unifier(
-        const std::vector<unsigned int> &indices_A, const V1 &data_A, size_t components_A,
-        const std::vector<unsigned int> &indices_B, const V2 &data_B, size_t components_B,
-        const std::vector<unsigned int> &indices_C, const V3 &data_C, size_t components_C)
-    {
-
-        std::vector<unsigned int> partially_unified_indices;
-        V1 partially_unified_dataA;
-        V2 partially_unified_dataB;
-        V3 partially_unified_dataC;
-        std::unordered_map<index_pair, unsigned int> partially_unified_index_map;
-
-        for (std::size_t i = 0; i < indices_A.size(); i++) {
-            if (partially_unified_index_map.find({ indices_A[i], indices_B[i] }) == partially_unified_index_map.end()) {
-                partially_unified_index_map[ {indices_A[i], indices_B[i]} ] = partially_unified_dataA.size()/components_A;
-                partially_unified_indices.push_back(partially_unified_dataA.size()/components_A);
-
-                for(std::size_t j=0; j<components_A; j++)
-                    partially_unified_dataA.push_back(data_A[indices_A[i]*components_A + j]);
-                for (std::size_t j = 0; j<components_B; j++)
-                    partially_unified_dataB.push_back(data_B[indices_B[i]*components_B + j]);
-            }
-            else {
-                partially_unified_indices.push_back(partially_unified_index_map[{indices_A[i], indices_B[i]}]);
+    static bool load_mesh_cache(const char *file_name, std::uint64_t source_size, std::int64_t source_time,
+                         MeshGeometry::Data &data) {
+        std::string cache_name = mesh_cache_name(file_name);
+#ifdef GIVR_MESH_CACHE_MMAP
+        int fd = open(cache_name.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        bool loaded = false;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                loaded = read_mesh_cache(static_cast<const char *>(mapped), info.st_size,
+                                         source_size, source_time, data);
+                munmap(mapped, info.st_size);
             }
         }
+        close(fd);
+        return loaded;
+#else
+        std::ifstream in(cache_name, std::ios::binary);
+        if (!in) return false;
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return read_mesh_cache(bytes.data(), bytes.size(), source_size, source_time, data);
+#endif
+    }
 
-        std::vector<unsigned int> unified_indices;
-        V1 unified_dataA;
-        V2 unified_dataB;
-        V3 unified_dataC;
-        std::unordered_map<index_pair, unsigned int> unified_index_map;
-
-        for (std::size_t i = 0; i < partially_unified_indices.size(); i++) {
-            if (unified_index_map.find({ partially_unified_indices[i], indices_C[i] }) == unified_index_map.end()) {
-                unified_index_map[{partially_unified_indices[i], indices_C[i] }] = unified_dataA.size()/components_A;
-                unified_indices.push_back(unified_dataA.size()/components_A);
-
-                for (std::size_t j = 0; j<components_A; j++)
-                    unified_dataA.push_back(partially_unified_dataA[partially_unified_indices[i] * components_A + j]);
-                for (std::size_t j = 0; j<components_B; j++)
-                    unified_dataB.push_back(partially_unified_dataB[partially_unified_indices[i] * components_B + j]);
-                for (std::size_t j = 0; j<components_C; j++)
-                    unified_dataC.push_back(data_C[indices_C[i] * components_C + j]);
-            }
-            else {
-                unified_indices.push_back(unified_index_map[{ partially_unified_indices[i], indices_C[i] }]);
+    // written to a temporary and renamed so a reader never sees half of it
+    static void save_mesh_cache(const char *file_name, std::uint64_t source_size, std::int64_t source_time,
+                         const MeshGeometry::Data &data) {
+        mesh_cache_header header = {};
+        std::memcpy(header.magic, mesh_cache_magic, sizeof(header.magic));
+        header.version = mesh_cache_version;
+        header.byte_order = mesh_cache_byte_order;
+        header.source_size = source_size;
+        header.source_time = source_time;
+        header.vertex_count = data.vertices.size();
+        header.normal_count = data.normals.size();
+        header.uv_count = data.uvs.size();
+        header.index_count = data.indices.size();
+
+        std::string cache_name = mesh_cache_name(file_name);
+        std::string temp_name = cache_name + ".tmp";
+        {
+            std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+            if (!out) return; // read-only model directory, parse every time
+            auto write = [&out](const auto &values) {
+                using value_t = typename std::decay_t<decltype(values)>::value_type;
+                out.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(value_t));
+            };
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            write(data.vertices);
+            write(data.normals);
+            write(data.uvs);
+            write(data.indices);
+            if (!out) {
+                out.close();
+                std::remove(temp_name.c_str());
+                return;
             }
         }
 
-        return { unified_indices, unified_dataA, unified_dataB, unified_dataC };
+        std::error_code error;
+        std::filesystem::rename(temp_name, cache_name, error);
+        if (error)
+            std::remove(temp_name.c_str());
     }
 
     MeshGeometry::Data loadMeshFile(const char *file_name) {
 
+        std::uint64_t source_size = 0;
+        std::int64_t source_time = 0;
+        bool cacheable = mesh_source_key(file_name, source_size, source_time);
+        if (cacheable) {
+            MeshGeometry::Data cached;
+            if (load_mesh_cache(file_name, source_size, source_time, cached))
+                return cached;
+        }
+
         //Tiny obj loading
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
@@ -1221,7 +1323,7 @@ namespace geometry {
         else if (multi_index_normal_data.size() == 0 && multi_index_uv_data.size() != 0) {
             auto[unified_indices, unified_vertices, unified_uvs] = two_index_unifier(
                 vertex_indices, multi_index_vertex_data, 3,
-                normal_indices, multi_index_uv_data, 2
+                uv_indices, multi_index_uv_data, 2
             );
 
             unifiedIndexMesh.indices = unified_indices;
@@ -1241,6 +1343,8 @@ namespace geometry {
         }
 
         //unifiedIndexMesh.uvs.resize(unifiedIndexMesh.vertices.size() * 2 / 3);
+        if (cacheable)
+            save_mesh_cache(file_name, source_size, source_time, unifiedIndexMesh);
         return unifiedIndexMesh;
 
     }
@@ -1650,3 +1754,117 @@ Buffer::~Buffer() {
 // END buffer.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start instance_ring.cpp
+//------------------------------------------------------------------------------
+#include <cstring>
+
+using InstanceRing = givr::InstanceRing;
+
+InstanceRing::InstanceRing(
+    std::size_t stride,
+    std::size_t capacity
+) : m_stride{stride},
+    m_capacity{0},
+    m_persistent{GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage}
+{
+    allocate(capacity > 0 ? capacity : 1);
+}
+
+InstanceRing::~InstanceRing() {
+    release();
+}
+
+void InstanceRing::allocate(std::size_t capacity) {
+    release();
+    m_capacity = capacity;
+    GLsizeiptr size = REGIONS * m_capacity * m_stride;
+
+    glGenBuffers(1, &m_bufferID);
+    glBindBuffer(GL_ARRAY_BUFFER, m_bufferID);
+    if (m_persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        m_mapped = static_cast<unsigned char *>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags)
+        );
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        m_staging.resize(m_capacity * m_stride);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceRing::release() {
+    for (GLsync &fence : m_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (m_bufferID) {
+        // GL keeps the storage alive until draws still reading it are done
+        if (m_mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_bufferID);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            m_mapped = nullptr;
+        }
+        glDeleteBuffers(1, &m_bufferID);
+        m_bufferID = 0;
+    }
+}
+
+void InstanceRing::waitForRegion(std::size_t region) {
+    GLsync &fence = m_fences[region];
+    if (!fence) {
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void *InstanceRing::push() {
+    if (!m_regionReady) {
+        waitForRegion(m_region);
+        m_regionReady = true;
+    }
+
+    if (m_count == m_capacity) {
+        // grow, keeping what was written this frame; the new buffer is unused
+        // so the first region can be written straight away
+        std::vector<unsigned char> written(m_count * m_stride);
+        std::memcpy(written.data(), m_persistent ? m_mapped + offset() : m_staging.data(), written.size());
+        allocate(m_capacity * 2);
+        m_region = 0;
+        std::memcpy(m_persistent ? m_mapped : m_staging.data(), written.data(), written.size());
+    }
+
+    unsigned char *base = m_persistent ? m_mapped + offset() : m_staging.data();
+    return base + (m_count++) * m_stride;
+}
+
+void InstanceRing::flush() {
+    if (!m_persistent && m_count > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_bufferID);
+        glBufferSubData(GL_ARRAY_BUFFER, offset(), m_count * m_stride, m_staging.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void InstanceRing::submit() {
+    if (m_persistent && m_regionReady) {
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    m_region = (m_region + 1) % REGIONS;
+    m_count = 0;
+    m_regionReady = false;
+}
+//------------------------------------------------------------------------------
+// END instance_ring.cpp
+//------------------------------------------------------------------------------
+
@@ -26,6 +26,7 @@
 //------------------------------------------------------------------------------
 // Start utility.h
 //------------------------------------------------------------------------------
+#include <ostream>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -10166,6 +10167,75 @@ namespace givr {
 // END buffer.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start instance_ring.h
+//------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <vector>
+
+namespace givr {
+
+    // Per instance data written straight into GPU visible memory. The buffer
+    // is split into three regions that are used in turn, one per frame, and
+    // each is fenced after its draw so the CPU only writes a region once the
+    // GPU has finished reading it. Storage is allocated once with
+    // glBufferStorage and stays mapped; it is only reallocated if a frame
+    // needs more instances than a region holds.
+    //
+    // Without GL 4.4 or ARB_buffer_storage the instances are staged on the
+    // CPU and copied into the same region layout with glBufferSubData.
+    class InstanceRing
+    {
+        public:
+            static constexpr std::size_t REGIONS = 3;
+
+            InstanceRing(std::size_t stride, std::size_t capacity = 1024);
+
+            // But no copy or assignment. Bad.
+            InstanceRing(const InstanceRing & ) = delete;
+            InstanceRing &operator=(const InstanceRing &) = delete;
+
+            ~InstanceRing();
+
+            operator GLuint() const { return m_bufferID; }
+
+            // space for one more instance in this frame's region
+            void *push();
+            // instances pushed since the last submit
+            std::size_t count() const { return m_count; }
+            // byte offset of this frame's region into the buffer
+            std::size_t offset() const { return m_region * m_capacity * m_stride; }
+            std::size_t stride() const { return m_stride; }
+            bool persistent() const { return m_persistent; }
+
+            // makes this frame's instances visible to the GPU, call before drawing
+            void flush();
+            // fences this frame's region after drawing and moves to the next one
+            void submit();
+
+        private:
+            void allocate(std::size_t capacity);
+            void release();
+            void waitForRegion(std::size_t region);
+
+            GLuint m_bufferID = 0;
+            unsigned char *m_mapped = nullptr;
+            std::vector<unsigned char> m_staging; // fallback when not persistent
+            GLsync m_fences[REGIONS] = {};
+
+            std::size_t m_stride;
+            std::size_t m_capacity; // instances per region
+            std::size_t m_region = 0;
+            std::size_t m_count = 0;
+            bool m_persistent;
+            bool m_regionReady = false;
+    };
+};// end namespace givr
+//------------------------------------------------------------------------------
+// END instance_ring.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start vertex_array.h
 //------------------------------------------------------------------------------
@@ -10286,7 +10356,8 @@ namespace givr {
     }
     template <typename ContextT>
     void addInstance(ContextT &ctx, glm::mat4 const &f) {
-        ctx.modelTransforms.push_back(f);
+        assert(ctx.instances->stride() == sizeof(mat4f));
+        std::memcpy(ctx.instances->push(), &f, sizeof(mat4f));
     }
 
 }
@@ -10513,6 +10584,7 @@ namespace style {
     using Width = utility::Type<float, struct Width_Tag>;
     using GenerateNormals = utility::Type<bool, struct GenerateNormals_Tag>;
     using ColorTexture = utility::Type<Texture, struct ColorTexture_Tag>;
+    using UpDirection = utility::Type<vec3f, struct UpDirection_Tag>;
 
 } // end namespace style
 } // end namespace givr
@@ -10734,8 +10806,11 @@ namespace givr {
         std::unique_ptr<Program> shaderProgram;
         std::unique_ptr<VertexArray> vao;
 
-        std::vector<mat4f> modelTransforms;
-        std::unique_ptr<Buffer> modelTransformsBuffer;
+        // Per instance data for this frame, by default the model matrix.
+        // instanceAttributes holds the float count of each per instance
+        // attribute in order, they take the first attribute locations.
+        std::unique_ptr<InstanceRing> instances;
+        std::vector<GLint> instanceAttributes = {4, 4, 4, 4};
 
         // Keep references to the GL_ARRAY_BUFFERS so that
         // the stay in scope for this context.
@@ -10758,6 +10833,15 @@ namespace givr {
         InstancedRenderContext &operator=(const InstancedRenderContext &) = delete;
     };
 
+    // Called with begin = true/false around the GL submission of every
+    // instanced draw when set, so applications can time or trace draws.
+    using DrawZoneCallback = void (*)(const char *name, bool begin);
+    extern DrawZoneCallback drawZoneCallback;
+
+    // points the per instance attributes at this frame's region of the ring
+    void bindInstanceAttributes(InstancedRenderContext &ctx);
+    std::size_t instanceStride(InstancedRenderContext const &ctx);
+
     template <typename ViewContextT>
     void drawInstanced(
         InstancedRenderContext &ctx,
@@ -10778,22 +10862,29 @@ namespace givr {
         ctx.vao->bind();
         glPolygonMode(GL_FRONT, GL_FILL);
         GLenum mode = givr::getMode(ctx.primitive);
-        ctx.modelTransformsBuffer->bind(GL_ARRAY_BUFFER);
-        ctx.modelTransformsBuffer->data(GL_ARRAY_BUFFER, ctx.modelTransforms, GL_DYNAMIC_DRAW);
+        InstanceRing &instances = *ctx.instances;
+        if (drawZoneCallback) {
+            drawZoneCallback("drawInstanced", true);
+        }
+        instances.flush();
+        bindInstanceAttributes(ctx);
 
         if (ctx.numberOfIndices > 0) {
             glDrawElementsInstanced(
-                mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0, ctx.modelTransforms.size()
+                mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0, instances.count()
             );
         } else {
             glDrawArraysInstanced(
-                mode, ctx.startIndex, ctx.endIndex, ctx.modelTransforms.size()
+                mode, ctx.startIndex, ctx.endIndex, instances.count()
             );
         }
+        if (drawZoneCallback) {
+            drawZoneCallback("drawInstanced", false);
+        }
 
         ctx.vao->unbind();
 
-        ctx.modelTransforms.clear();
+        instances.submit();
     }
     void allocateBuffers(
         InstancedRenderContext &ctx
@@ -11262,8 +11353,12 @@ namespace geometry {
 // Start mesh.h
 //------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace givr {
@@ -11315,6 +11410,149 @@ namespace geometry {
 
     MeshGeometry::Data generateGeometry(const MeshGeometry& m);
 
+    // Open addressing (linear probing) table from a tuple of OBJ indices to
+    // the unified index it was given, for merging the separate vertex,
+    // normal and uv index streams of an OBJ into one index buffer.
+    template <std::size_t N>
+    class index_tuple_table {
+    public:
+        using key_type = std::array<unsigned int, N>;
+
+        // sized for expected tuples at most half full, grows past that
+        explicit index_tuple_table(std::size_t expected) {
+            std::size_t size = 16;
+            while (size < expected * 2)
+                size *= 2;
+            slots.assign(size, slot{key_type{}, empty});
+        }
+
+        // the unified index of key, or value (and true) if it is new
+        std::pair<unsigned int, bool> insert(const key_type &key, unsigned int value) {
+            if ((count + 1) * 2 > slots.size())
+                rehash(slots.size() * 2);
+
+            std::size_t mask = slots.size() - 1;
+            for (std::size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+                slot &s = slots[i];
+                if (s.value == empty) {
+                    s.key = key;
+                    s.value = value;
+                    count++;
+                    return { value, true };
+                }
+                if (s.key == key)
+                    return { s.value, false };
+            }
+        }
+
+    private:
+        struct slot {
+            key_type key;
+            unsigned int value;
+        };
+        static constexpr unsigned int empty = ~0u;
+
+        static std::size_t hash(const key_type &key) {
+            std::uint64_t h = 0x9e3779b97f4a7c15ull;
+            for (unsigned int k : key) {
+                h = (h ^ k) * 0xff51afd7ed558ccdull;
+                h ^= h >> 32;
+            }
+            return static_cast<std::size_t>(h);
+        }
+
+        void rehash(std::size_t size) {
+            std::vector<slot> old(size, slot{key_type{}, empty});
+            old.swap(slots);
+            std::size_t mask = size - 1;
+            for (const slot &s : old) {
+                if (s.value == empty) continue;
+                std::size_t i = hash(s.key) & mask;
+                while (slots[i].value != empty)
+                    i = (i + 1) & mask;
+                slots[i] = s;
+            }
+        }
+
+        std::vector<slot> slots;
+        std::size_t count = 0;
+    };
+
+    // Unified indices and data for two index streams: each distinct
+    // (A, B) pair becomes one output vertex, numbered in order of first use.
+    template<typename V1, typename V2>
+    std::tuple<std::vector<unsigned int>, V1, V2> two_index_unifier(
+        const std::vector<unsigned int> &indices_A, const V1 &data_A, size_t components_A,
+        const std::vector<unsigned int> &indices_B, const V2 &data_B, size_t components_B)
+    {
+        // at least one output vertex per input one
+        std::size_t expected = std::max(data_A.size() / components_A, data_B.size() / components_B);
+        index_tuple_table<2> index_map(expected);
+
+        std::vector<unsigned int> unified_indices;
+        V1 unified_dataA;
+        V2 unified_dataB;
+        unified_indices.reserve(indices_A.size());
+        unified_dataA.reserve(expected * components_A);
+        unified_dataB.reserve(expected * components_B);
+
+        unsigned int next = 0;
+        for (std::size_t i = 0; i < indices_A.size(); i++) {
+            unsigned int a = indices_A[i], b = indices_B[i];
+            auto [index, inserted] = index_map.insert({{ a, b }}, next);
+            if (inserted) {
+                next++;
+                unified_dataA.insert(unified_dataA.end(), data_A.begin() + a * components_A,
+                                     data_A.begin() + (a + 1) * components_A);
+                unified_dataB.insert(unified_dataB.end(), data_B.begin() + b * components_B,
+                                     data_B.begin() + (b + 1) * components_B);
+            }
+            unified_indices.push_back(index);
+        }
+
+        return { unified_indices, unified_dataA, unified_dataB };
+    }
+
+    // Same for three index streams and (A, B, C) triples.
+    template<typename V1, typename V2, typename V3>
+    std::tuple<std::vector<unsigned int>, V1, V2, V3> three_index_unifier(
+        const std::vector<unsigned int> &indices_A, const V1 &data_A, size_t components_A,
+        const std::vector<unsigned int> &indices_B, const V2 &data_B, size_t components_B,
+        const std::vector<unsigned int> &indices_C, const V3 &data_C, size_t components_C)
+    {
+        std::size_t expected = std::max({ data_A.size() / components_A,
+                                          data_B.size() / components_B,
+                                          data_C.size() / components_C });
+        index_tuple_table<3> index_map(expected);
+
+        std::vector<unsigned int> unified_indices;
+        V1 unified_dataA;
+        V2 unified_dataB;
+        V3 unified_dataC;
+        unified_indices.reserve(indices_A.size());
+        unified_dataA.reserve(expected * components_A);
+        unified_dataB.reserve(expected * components_B);
+        unified_dataC.reserve(expected * components_C);
+
+        unsigned int next = 0;
+        for (std::size_t i = 0; i < indices_A.size(); i++) {
+            unsigned int a = indices_A[i], b = indices_B[i], c = indices_C[i];
+            auto [index, inserted] = index_map.insert({{ a, b, c }}, next);
+            if (inserted) {
+                next++;
+                unified_dataA.insert(unified_dataA.end(), data_A.begin() + a * components_A,
+                                     data_A.begin() + (a + 1) * components_A);
+                unified_dataB.insert(unified_dataB.end(), data_B.begin() + b * components_B,
+                                     data_B.begin() + (b + 1) * components_B);
+                unified_dataC.insert(unified_dataC.end(), data_C.begin() + c * components_C,
+                                     data_C.begin() + (c + 1) * components_C);
+            }
+            unified_indices.push_back(index);
+        }
+
+        return { unified_indices, unified_dataA, unified_dataB, unified_dataC };
+    }
+
 }// end namespace geometry
 }// end namespace givr
 //------------------------------------------------------------------------------
@@ -11815,7 +12053,7 @@ namespace givr {
         };
 
 
-        std::string phongVertexSource(std::string modelSource, bool usingTexture);
+        std::string phongVertexSource(std::string modelSource, bool usingTexture, std::string modelSetup = "");
         std::string phongGeometrySource();
         std::string phongFragmentSource(bool usingTexture);
 
@@ -12064,6 +12302,161 @@ namespace givr {
 // END phong.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start framed_phong.h
+//------------------------------------------------------------------------------
+// Example Code:
+// auto boids = createInstancedRenderable(Mesh(Filename("bee.obj")),
+//     FramedPhong(Colour(1., 1., 0.), LightPosition(100., 100., 100.)));
+// for (..) {
+//     addInstance(boids, position, velocity, force);
+// }
+// draw(boids, view);
+//------------------------------------------------------------------------------
+
+#include <string>
+
+namespace givr {
+    namespace style {
+
+        // Phong shading for instances given as a position, velocity and force
+        // (9 floats) instead of a model matrix (16 floats). The vertex shader
+        // builds the frame: the mesh's z axis follows the velocity and the
+        // up direction plus the force decides which way is up.
+        struct FramedPhongParameters : public Style<
+            Colour,
+            LightPosition,
+            SpecularFactor,
+            AmbientFactor,
+            PhongExponent,
+            PerVertexColour,
+            ShowWireFrame,
+            WireFrameColour,
+            WireFrameWidth,
+            GenerateNormals,
+            UpDirection
+        > {
+            FramedPhongParameters() {
+                // Default values
+                this->set(PerVertexColour(false));
+                this->set(AmbientFactor(0.05f));
+                this->set(SpecularFactor(0.3f));
+                this->set(PhongExponent(8.0f));
+                this->set(ShowWireFrame(false));
+                this->set(WireFrameColour(0.f, 0.f, 0.f));
+                this->set(WireFrameWidth(1.5f));
+                this->set(GenerateNormals(false));
+                this->set(UpDirection(0.f, 1.f, 0.f));
+            }
+        };
+
+        std::string framedPhongVertexSource();
+
+        struct FramedPhongInstancedRenderContext
+            :
+            public FramedPhongParameters,
+            public InstancedRenderContext
+        {
+            FramedPhongInstancedRenderContext() {
+                instanceAttributes = {3, 3, 3}; // position, velocity, force
+            }
+
+            void setUniforms(std::unique_ptr<Program> const &p) const {
+                setPhongUniforms(*this, p);
+                p->setVec3("upDirection", value<UpDirection>());
+            }
+
+            std::string getVertexShaderSource() const {
+                return framedPhongVertexSource();
+            }
+            std::string getGeometryShaderSource() const {
+                return phongGeometrySource();
+            }
+            std::string getFragmentShaderSource() const {
+                return phongFragmentSource(false);
+            }
+        };
+
+        struct FramedPhongStyle : public FramedPhongParameters {
+            using InstancedRenderContext = FramedPhongInstancedRenderContext;
+        };
+
+        template <typename... Args>
+        FramedPhongStyle FramedPhong(Args &&... args) {
+            using required_args = std::tuple<LightPosition, Colour>;
+
+            using namespace utility;
+            static_assert(!has_duplicate_types<Args...>,
+                "The arguments you passed in have duplicate parameters");
+
+            static_assert(
+                is_subset_of<required_args, std::tuple<Args...>> &&
+                is_subset_of<std::tuple<Args...>, FramedPhongStyle::Args> &&
+                sizeof...(args) <= std::tuple_size<FramedPhongStyle::Args>::value,
+                "You have provided incorrect parameters for framed phong. "
+                "LightPosition and Colour are required. AmbientFactor, "
+                "SpecularFactor, PhongExponent, PerVertexColor and UpDirection "
+                "are optional.");
+
+            FramedPhongStyle p;
+            p.set(std::forward<Args>(args)...);
+            return p;
+        }
+
+        template <typename GeometryT>
+        BufferData fillBuffers(GeometryT const &g, FramedPhongStyle const &) {
+            // same mesh data as phong, only the instance data differs
+            return fillBuffers(g, PhongStyle());
+        }
+
+        inline void updateStyle(FramedPhongInstancedRenderContext &ctx, FramedPhongStyle const &p) {
+            ctx.set(p.args);
+        }
+
+        template <typename GeometryT>
+        FramedPhongInstancedRenderContext
+            getInstancedContext(GeometryT &, FramedPhongStyle const &p) {
+            FramedPhongInstancedRenderContext ctx;
+            ctx.shaderProgram = std::make_unique<Program>(
+                Shader{ ctx.getVertexShaderSource(), GL_VERTEX_SHADER },
+                Shader{ ctx.getGeometryShaderSource(), GL_GEOMETRY_SHADER },
+                Shader{ ctx.getFragmentShaderSource(), GL_FRAGMENT_SHADER }
+            );
+            ctx.primitive = getPrimitive<GeometryT>();
+            updateStyle(ctx, p);
+            return ctx;
+        }
+
+        inline void addInstance(
+            FramedPhongInstancedRenderContext &ctx,
+            vec3f const &position,
+            vec3f const &velocity,
+            vec3f const &force
+        ) {
+            float *instance = static_cast<float *>(ctx.instances->push());
+            std::memcpy(instance, &position, sizeof(vec3f));
+            std::memcpy(instance + 3, &velocity, sizeof(vec3f));
+            std::memcpy(instance + 6, &force, sizeof(vec3f));
+        }
+
+        template <typename ViewContextT>
+        void draw(FramedPhongInstancedRenderContext &ctx, ViewContextT const &viewCtx) {
+            glEnable(GL_MULTISAMPLE);
+            glEnable(GL_DEPTH_TEST);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            drawInstanced(ctx, viewCtx, [&ctx](std::unique_ptr<Program> const &program) {
+                ctx.setUniforms(program);
+            });
+        }
+
+    }// end namespace style
+}// end namespace givr
+
+//------------------------------------------------------------------------------
+// END framed_phong.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start triangle_soup.h
 //------------------------------------------------------------------------------
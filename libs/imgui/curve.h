@@ -395,7 +395,7 @@ inline void spline(const float *key, int num, int dim, float t, float *v) {
 
   // find key
   int k = 0;
-  while (key[k * size] < t)
+  while (k < num - 1 && key[k * size] < t)
     k++;
 
   // interpolant
@@ -429,17 +429,14 @@ inline float CurveValueSmooth(float p, int maxpoints, const ImVec2 *points) {
   if (p < 0)
     return points[0].y;
 
-  float *input = new float[maxpoints * 2];
-  float output[4];
-
-  for (int i = 0; i < maxpoints; ++i) {
-    input[i * 2 + 0] = points[i].x;
-    input[i * 2 + 1] = points[i].y;
-  }
+  // spline would read ahead of the keys, which came out as the first point
+  if (p <= points[0].x)
+    return points[0].y;
 
-  spline(input, maxpoints, 1, p, output);
+  // ImVec2 is (x, y), so the points already are (t0,x0,t1,x1 ...) keys
+  float output[4];
+  spline(&points[0].x, maxpoints, 1, p, output);
 
-  delete[] input;
   return output[0];
 }
 
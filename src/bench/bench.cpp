@@ -0,0 +1,243 @@
+//------------------------------------------------------------------------------
+// Filename: bench.cpp
+//
+// Author: Glenn Skelton
+//
+// Last modified: October 18, 2026
+//
+// Scaling benchmark for the simulation step. Runs every combination of boid
+// count, thread count and obstacle mode and reports ns per boid-step,
+// speedup and parallel efficiency against one thread, and memory per boid.
+// The arena radius grows with the boid count so every run keeps the
+// density of the config file.
+//
+// First it checks the avoidance force from the force table against the
+// exact one over the whole avoidance band, and each vector pair kernel the
+// cpu runs against the scalar one on random neighbour sets. Exits with a
+// failure if a kernel differs by more than PAIR_KERNEL_TOLERANCE.
+//
+// usage: boids_bench [--max-boids N] [--max-threads N] [--work N]
+//                    [--json file] [--config file]
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "forcetable.h"
+#include "parser.h"
+#include "simulation.h"
+
+using namespace std;
+using namespace givr::fileIO;
+
+
+// one measured configuration
+struct BenchResult {
+    unsigned int boids;
+    unsigned int threads;
+    bool obstacles;
+    unsigned int steps;
+    double nsPerBoidStep;
+    double speedup;
+    double efficiency;
+    double bytesPerBoid;
+};
+
+
+// boid counts to run, from the shipped config up to a million
+const unsigned int BOID_COUNTS[] = {500, 5000, 50000, 250000, 1000000};
+constexpr unsigned int BENCH_SEED = 587;
+
+// distances the force table is checked at, and the error it may have
+constexpr unsigned int ACCURACY_SAMPLES = 100000;
+constexpr float ACCURACY_LIMIT = 0.005f;
+
+// neighbour sets the vector pair kernels are checked on
+constexpr unsigned int KERNEL_CHECK_SETS = 20000;
+
+
+/**
+ * To fall back on the shipped config values when no config file is found.
+ */
+void setDefaultParameters(struct ProgramParameters &p) {
+    p.numBoids = 500;
+    p.boidMass = 0.1f;
+    p.avoidanceRange = 2.1f;
+    p.cohesionRange = 2.5f;
+    p.maxSearchRange = 2.8f;
+    p.avoidanceMultiplier = 40.0f;
+    p.cohesionMultiplier = 3.0f;
+    p.gatherMultiplier = 1.0f;
+    p.arenaRadius = 40.0f;
+    p.forceMultiplier = 100.0f;
+    p.minVelocity = 15.0f;
+    p.maxVelocity = 20.0f;
+}
+
+/**
+ * To time a_steps substeps of a fresh flock with the given setup.
+ */
+BenchResult runBenchmark(const struct ProgramParameters &a_base,
+                         const unsigned int &a_boids,
+                         const unsigned int &a_threads,
+                         const bool &a_obstacles,
+                         const unsigned long &a_work) {
+    struct ProgramParameters params = a_base;
+    params.numBoids = a_boids;
+    params.numThreads = a_threads;
+    params.arenaRadius = a_base.arenaRadius * std::cbrt(static_cast<float>(a_boids) / a_base.numBoids);
+
+    Simulation sim(params);
+    sim.spawnBoids(BENCH_SEED);
+    sim.addObstacle({vec3f(0.0, 0.0, params.arenaRadius),
+                     vec3f(0.0, 0.0, -params.arenaRadius),
+                     params.maxSearchRange * 0.7f});
+    sim.setObstacleMode(a_obstacles);
+
+    unsigned int steps = std::max(2ul, a_work / a_boids);
+    sim.step(DELTA_T); // warm up, sizes the grid and accumulators
+
+    auto start = chrono::steady_clock::now();
+    sim.advance(steps, DELTA_T);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    BenchResult result;
+    result.boids = a_boids;
+    result.threads = sim.getThreadCount();
+    result.obstacles = a_obstacles;
+    result.steps = steps;
+    result.nsPerBoidStep = (seconds * 1e9) / (static_cast<double>(a_boids) * steps);
+    result.speedup = 1.0;
+    result.efficiency = 1.0;
+    result.bytesPerBoid = static_cast<double>(sim.getMemoryUsage()) / a_boids;
+    return result;
+}
+
+/**
+ * To write every result out as JSON.
+ */
+bool writeJSON(const vector<BenchResult> &a_results, const string &a_filename) {
+    ofstream oFile(a_filename);
+    if (!oFile.is_open()) return false;
+
+    oFile << "{\n  \"delta_t\": " << DELTA_T << ",\n  \"results\": [\n";
+    for (unsigned int i = 0; i < a_results.size(); i++) {
+        const BenchResult &r = a_results[i];
+        oFile << "    {\"boids\": " << r.boids
+              << ", \"threads\": " << r.threads
+              << ", \"obstacles\": " << (r.obstacles ? "true" : "false")
+              << ", \"steps\": " << r.steps
+              << ", \"ns_per_boid_step\": " << r.nsPerBoidStep
+              << ", \"speedup\": " << r.speedup
+              << ", \"efficiency\": " << r.efficiency
+              << ", \"bytes_per_boid\": " << r.bytesPerBoid << "}"
+              << (i + 1 < a_results.size() ? ",\n" : "\n");
+    }
+    oFile << "  ]\n}\n";
+    return true;
+}
+
+
+int main(int argc, char *argv[]) {
+    unsigned int maxBoids = 1000000;
+    unsigned int maxThreads = std::max(1u, thread::hardware_concurrency());
+    unsigned long work = 4000000; // boid-steps per measurement
+    string jsonFile = "boids_bench.json";
+    string config = "configFiles/config.txt";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--max-boids") == 0) maxBoids = strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--max-threads") == 0) maxThreads = std::max(1ul, strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--work") == 0) work = strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--json") == 0) jsonFile = argv[i + 1];
+        else if (strcmp(argv[i], "--config") == 0) config = argv[i + 1];
+        else {
+            cout << "usage: " << argv[0] << " [--max-boids N] [--max-threads N] [--work N]"
+                 << " [--json file] [--config file]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct ProgramParameters base;
+    if (!parseConfigFile(base, config) || base.numBoids == 0) {
+        cout << "using default parameters" << endl;
+        setDefaultParameters(base);
+    }
+
+    // the table against the exact avoidance force, with the config's curve
+    {
+        Simulation sim(base);
+        const vector<float> &curve = sim.getForceCurve();
+        float straddled;
+        float error = ForceTable::checkAccuracy(base.avoidanceRange, base.cohesionRange, base.maxSearchRange,
+                                                base.avoidanceMultiplier, curve.data(), curve.size(),
+                                                ACCURACY_SAMPLES, straddled);
+        printf("force table: avoidance force within %.3g%% of exact over the avoidance band%s "
+               "(%.1f%% of distances in bins straddling a curve bucket edge left out)\n",
+               100.0 * error, error <= ACCURACY_LIMIT ? "" : " - TOO LARGE", 100.0 * straddled);
+
+        // the vector kernels against the scalar one, on the table of the config
+        ForceTable table;
+        table.build(base.avoidanceRange, base.cohesionRange, base.maxSearchRange, base.avoidanceMultiplier,
+                    base.cohesionMultiplier, base.gatherMultiplier, 1.0f, curve.data(), curve.size());
+        bool kernelsMatch = true;
+        for (PairKernelType type : {PairKernelType::SSE, PairKernelType::AVX2}) {
+            if (resolvePairKernel(type) != type) continue; // not on this cpu
+            float difference = comparePairKernel(type, table.getKernelParams(), base.maxSearchRange,
+                                                 KERNEL_CHECK_SETS, BENCH_SEED);
+            bool matches = difference <= PAIR_KERNEL_TOLERANCE;
+            printf("%s pair kernel: within %.3g of scalar%s\n", pairKernelName(type), difference,
+                   matches ? "" : " - MISMATCH");
+            kernelsMatch = kernelsMatch && matches;
+        }
+        if (!kernelsMatch) {
+            base.graphValues->clear();
+            delete base.graphValues;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // 1, 2, 4, ... threads and always the max
+    vector<unsigned int> threadCounts;
+    for (unsigned int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    vector<BenchResult> results;
+    printf("%10s %8s %9s %7s %14s %9s %10s %13s\n",
+           "boids", "threads", "obstacle", "steps", "ns/boid-step", "speedup", "efficiency", "bytes/boid");
+
+    for (unsigned int boids : BOID_COUNTS) {
+        if (boids > maxBoids) break;
+
+        for (bool obstacles : {false, true}) {
+            double serial = 0.0;
+            for (unsigned int threads : threadCounts) {
+                BenchResult r = runBenchmark(base, boids, threads, obstacles, work);
+                if (threads == 1) serial = r.nsPerBoidStep;
+                r.speedup = serial / r.nsPerBoidStep;
+                r.efficiency = r.speedup / r.threads;
+                results.push_back(r);
+
+                printf("%10u %8u %9s %7u %14.1f %9.2f %10.2f %13.1f\n",
+                       r.boids, r.threads, r.obstacles ? "on" : "off", r.steps,
+                       r.nsPerBoidStep, r.speedup, r.efficiency, r.bytesPerBoid);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (writeJSON(results, jsonFile)) cout << "results written to " << jsonFile << endl;
+    else cout << "could not write " << jsonFile << endl;
+
+    base.graphValues->clear();
+    delete base.graphValues;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,308 @@
+//------------------------------------------------------------------------------
+// Filename: meshbench.cpp
+//
+// Author: Glenn Skelton
+//
+// Last modified: October 18, 2026
+//
+// Benchmark for the OBJ index unifiers in givr. Times the hash table
+// unifiers against the unordered_map ones they replaced on the shipped
+// models and a synthetic mesh of about a million triangles, and checks
+// both give exactly the same indices and data. Exits with a failure if
+// they don't.
+//
+// usage: boids_mesh_bench [--models dir] [--grid N] [--reps N]
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "givr.h"
+
+using namespace std;
+
+
+// shipped models, all positions and normals without uvs
+const char *MODELS[] = {"bee.obj", "bird.obj", "Palm_Tree.obj"};
+
+
+// separate index streams of a mesh, as loadMeshFile builds them
+struct IndexStreams {
+    string name;
+    vector<float> vertices;
+    vector<float> normals;
+    vector<float> uvs;
+    vector<unsigned int> vertexIndices;
+    vector<unsigned int> normalIndices;
+    vector<unsigned int> uvIndices;
+    double parseMs; // tinyobj, 0 for the synthetic mesh
+};
+
+// one measured mesh
+struct MeshResult {
+    string name;
+    size_t indices;
+    size_t unified; // output vertices
+    double parseMs;
+    double legacyMs;
+    double hashedMs;
+    bool identical;
+};
+
+
+//------------------------------------------------------------------------------
+// The unifiers as givr had them before, for the timings and the output check
+//------------------------------------------------------------------------------
+namespace legacy {
+
+struct index_pair {
+    unsigned int a, b;
+
+    bool operator==(const index_pair& rh) const {
+        return a == rh.a && b == rh.b;
+    }
+};
+
+struct index_pair_hash {
+    size_t operator()(const index_pair &key) const {
+        return size_t(key.a << 16) | size_t(key.b);
+    }
+};
+
+template<typename V1, typename V2>
+tuple<vector<unsigned int>, V1, V2> two_index_unifier(
+    const vector<unsigned int> &indices_A, const V1 &data_A, size_t components_A,
+    const vector<unsigned int> &indices_B, const V2 &data_B, size_t components_B)
+{
+    vector<unsigned int> unified_indices;
+    V1 unified_dataA;
+    V2 unified_dataB;
+    unordered_map<index_pair, unsigned int, index_pair_hash> index_map;
+
+    for (size_t i = 0; i < indices_A.size(); i++) {
+        if (index_map.find({ indices_A[i], indices_B[i] }) == index_map.end()) {
+            index_map[{indices_A[i], indices_B[i]}] = unified_dataA.size()/components_A;
+            unified_indices.push_back(unified_dataA.size()/components_A);
+
+            for (size_t j = 0; j < components_A; j++)
+                unified_dataA.push_back(data_A[indices_A[i]*components_A + j]);
+
+            for (size_t j = 0; j < components_B; j++)
+                unified_dataB.push_back(data_B[indices_B[i]*components_B + j]);
+        }
+        else {
+            unified_indices.push_back(index_map[{indices_A[i], indices_B[i]}]);
+        }
+    }
+
+    return { unified_indices, unified_dataA, unified_dataB };
+}
+
+template<typename V1, typename V2, typename V3>
+tuple<vector<unsigned int>, V1, V2, V3> three_index_unifier(
+    const vector<unsigned int> &indices_A, const V1 &data_A, size_t components_A,
+    const vector<unsigned int> &indices_B, const V2 &data_B, size_t components_B,
+    const vector<unsigned int> &indices_C, const V3 &data_C, size_t components_C)
+{
+    auto [partially_unified_indices, partially_unified_dataA, partially_unified_dataB] =
+        two_index_unifier(indices_A, data_A, components_A, indices_B, data_B, components_B);
+
+    vector<unsigned int> unified_indices;
+    V1 unified_dataA;
+    V2 unified_dataB;
+    V3 unified_dataC;
+    unordered_map<index_pair, unsigned int, index_pair_hash> unified_index_map;
+
+    for (size_t i = 0; i < partially_unified_indices.size(); i++) {
+        if (unified_index_map.find({ partially_unified_indices[i], indices_C[i] }) == unified_index_map.end()) {
+            unified_index_map[{partially_unified_indices[i], indices_C[i] }] = unified_dataA.size()/components_A;
+            unified_indices.push_back(unified_dataA.size()/components_A);
+
+            for (size_t j = 0; j<components_A; j++)
+                unified_dataA.push_back(partially_unified_dataA[partially_unified_indices[i] * components_A + j]);
+            for (size_t j = 0; j<components_B; j++)
+                unified_dataB.push_back(partially_unified_dataB[partially_unified_indices[i] * components_B + j]);
+            for (size_t j = 0; j<components_C; j++)
+                unified_dataC.push_back(data_C[indices_C[i] * components_C + j]);
+        }
+        else {
+            unified_indices.push_back(unified_index_map[{ partially_unified_indices[i], indices_C[i] }]);
+        }
+    }
+
+    return { unified_indices, unified_dataA, unified_dataB, unified_dataC };
+}
+
+} // namespace legacy
+
+
+/**
+ * To read the index streams of the first shape of an OBJ the way
+ * loadMeshFile does. Returns false if it can't be read.
+ */
+bool loadStreams(const string &a_file, IndexStreams &a_mesh) {
+    tinyobj::attrib_t attrib;
+    vector<tinyobj::shape_t> shapes;
+    vector<tinyobj::material_t> materials;
+    string errors;
+
+    auto start = chrono::steady_clock::now();
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &errors, a_file.c_str()) || shapes.empty())
+        return false;
+    a_mesh.parseMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    a_mesh.vertices = attrib.vertices;
+    a_mesh.normals = attrib.normals;
+    a_mesh.uvs = attrib.texcoords;
+    for (auto index : shapes[0].mesh.indices) {
+        a_mesh.vertexIndices.push_back(index.vertex_index);
+        a_mesh.normalIndices.push_back(index.normal_index);
+        a_mesh.uvIndices.push_back(index.texcoord_index);
+    }
+    return true;
+}
+
+/**
+ * To build an a_n by a_n grid of quads split into triangles with shared
+ * positions and uvs and a normal per quad (flat shaded), so each position
+ * is used with several normals.
+ */
+IndexStreams syntheticMesh(const unsigned int &a_n, const bool &a_withUVs) {
+    IndexStreams mesh;
+    mesh.name = "grid " + to_string(2ull * a_n * a_n / 1000) + "k tris" + (a_withUVs ? " +uv" : "");
+    mesh.parseMs = 0.0;
+
+    unsigned int side = a_n + 1;
+    for (unsigned int y = 0; y < side; y++) {
+        for (unsigned int x = 0; x < side; x++) {
+            float u = float(x) / a_n, v = float(y) / a_n;
+            float h = 0.1f * std::sin(6.0f * u) * std::cos(6.0f * v);
+            mesh.vertices.insert(mesh.vertices.end(), {u, h, v});
+            if (a_withUVs)
+                mesh.uvs.insert(mesh.uvs.end(), {u, v});
+        }
+    }
+
+    unsigned int normal = 0;
+    auto corner = [&](unsigned int a_x, unsigned int a_y) {
+        unsigned int vertex = a_y * side + a_x;
+        mesh.vertexIndices.push_back(vertex);
+        mesh.normalIndices.push_back(normal);
+        mesh.uvIndices.push_back(a_withUVs ? vertex : ~0u);
+    };
+    for (unsigned int y = 0; y < a_n; y++) {
+        for (unsigned int x = 0; x < a_n; x++, normal++) {
+            mesh.normals.insert(mesh.normals.end(), {0.0f, 1.0f, float(normal % 7) * 0.01f});
+            corner(x, y); corner(x + 1, y); corner(x + 1, y + 1);
+            corner(x, y); corner(x + 1, y + 1); corner(x, y + 1);
+        }
+    }
+    return mesh;
+}
+
+/**
+ * To time a_run a_reps times and return the fastest in ms.
+ */
+template <typename Run>
+double bestOf(const unsigned int &a_reps, Run &&a_run) {
+    double best = 1e300;
+    for (unsigned int r = 0; r < a_reps; r++) {
+        auto start = chrono::steady_clock::now();
+        a_run();
+        best = std::min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+/**
+ * To unify a_mesh both ways, with uvs if it has them.
+ */
+MeshResult benchMesh(const IndexStreams &a_mesh, const unsigned int &a_reps) {
+    MeshResult result;
+    result.name = a_mesh.name;
+    result.indices = a_mesh.vertexIndices.size();
+    result.parseMs = a_mesh.parseMs;
+
+    if (a_mesh.uvs.empty()) {
+        tuple<vector<unsigned int>, vector<float>, vector<float>> before, after;
+        result.legacyMs = bestOf(a_reps, [&]() {
+            before = legacy::two_index_unifier(a_mesh.vertexIndices, a_mesh.vertices, 3,
+                                               a_mesh.normalIndices, a_mesh.normals, 3);
+        });
+        result.hashedMs = bestOf(a_reps, [&]() {
+            after = givr::geometry::two_index_unifier(a_mesh.vertexIndices, a_mesh.vertices, 3,
+                                                      a_mesh.normalIndices, a_mesh.normals, 3);
+        });
+        result.unified = std::get<1>(after).size() / 3;
+        result.identical = before == after;
+    } else {
+        tuple<vector<unsigned int>, vector<float>, vector<float>, vector<float>> before, after;
+        result.legacyMs = bestOf(a_reps, [&]() {
+            before = legacy::three_index_unifier(a_mesh.vertexIndices, a_mesh.vertices, 3,
+                                                 a_mesh.normalIndices, a_mesh.normals, 3,
+                                                 a_mesh.uvIndices, a_mesh.uvs, 2);
+        });
+        result.hashedMs = bestOf(a_reps, [&]() {
+            after = givr::geometry::three_index_unifier(a_mesh.vertexIndices, a_mesh.vertices, 3,
+                                                        a_mesh.normalIndices, a_mesh.normals, 3,
+                                                        a_mesh.uvIndices, a_mesh.uvs, 2);
+        });
+        result.unified = std::get<1>(after).size() / 3;
+        result.identical = before == after;
+    }
+    return result;
+}
+
+
+int main(int argc, char *argv[]) {
+    string models = "models";
+    unsigned int grid = 708; // 2 * 708^2 ~ a million triangles
+    unsigned int reps = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--models") == 0 && i + 1 < argc) models = argv[++i];
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) grid = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = strtoul(argv[++i], nullptr, 10);
+        else {
+            cout << "usage: " << argv[0] << " [--models dir] [--grid N] [--reps N]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (grid == 0 || reps == 0) {
+        cout << "--grid and --reps must be positive" << endl;
+        return EXIT_FAILURE;
+    }
+
+    vector<MeshResult> results;
+    for (const char *model : MODELS) {
+        IndexStreams mesh;
+        mesh.name = model;
+        if (!loadStreams(models + "/" + model, mesh)) {
+            cout << "could not read " << models << "/" << model << ", skipped" << endl;
+            continue;
+        }
+        results.push_back(benchMesh(mesh, reps));
+    }
+    results.push_back(benchMesh(syntheticMesh(grid, false), reps));
+    results.push_back(benchMesh(syntheticMesh(grid, true), reps));
+
+    bool allIdentical = true;
+    printf("%-22s %10s %10s %10s %11s %11s %8s %s\n",
+           "mesh", "indices", "unified", "parse ms", "legacy ms", "hashed ms", "speedup", "output");
+    for (const MeshResult &r : results) {
+        printf("%-22s %10zu %10zu %10.2f %11.3f %11.3f %7.2fx %s\n",
+               r.name.c_str(), r.indices, r.unified, r.parseMs, r.legacyMs, r.hashedMs,
+               r.legacyMs / r.hashedMs, r.identical ? "identical" : "DIFFERENT");
+        allIdentical = allIdentical && r.identical;
+    }
+
+    return allIdentical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
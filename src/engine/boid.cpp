@@ -0,0 +1,70 @@
+/**
+ * Filename: boid.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: March 27, 2019
+ */
+
+#include "givr.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include "boid.h"
+#include "boidstore.h"
+
+using namespace std;
+using namespace givr;
+using namespace givr::geometry;
+
+
+// class: Boid
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+Boid::Boid(BoidStore *a_store, unsigned int a_slot) : m_store(a_store),
+                                                      m_slot(a_slot) {}
+
+Boid::~Boid() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+signed int Boid::getID() const { return this->m_store->getID(this->m_slot); }
+unsigned int Boid::getSlot() const { return this->m_slot; }
+
+float Boid::getMass() const { return this->m_store->getMass(this->m_slot); }
+void Boid::setMass(const float &a_mass) { this->m_store->setMass(this->m_slot, a_mass); }
+
+vec3f Boid::getInitialPosition() const { return this->m_store->getInitialPosition(this->m_slot); }
+
+vec3f Boid::getPosition() const { return this->m_store->positions().get(this->m_slot); }
+void Boid::setPosition(const vec3f &a_p) { this->m_store->positions().set(this->m_slot, a_p); }
+
+vec3f Boid::getLastForce() const { return this->m_store->lastForces().get(this->m_slot); }
+void Boid::setLastForce(const vec3f &a_lastForce) { this->m_store->lastForces().set(this->m_slot, a_lastForce); }
+
+vec3f Boid::getVelocity() const { return this->m_store->velocities().get(this->m_slot); }
+void Boid::setVelocity(const vec3f &a_v) { this->m_store->velocities().set(this->m_slot, a_v); }
+
+vec3f Boid::getNetForce() const { return this->m_store->forces().get(this->m_slot); }
+void Boid::setNetForce(const vec3f &a_F) { this->m_store->forces().set(this->m_slot, a_F); }
+void Boid::addNetForce(const vec3f &a_F) { this->m_store->forces().add(this->m_slot, a_F); }
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+
+/**
+ * To calculate the force of the boundary to apply to the boid to
+ * keep them contained.
+ */
+void Boid::calculateBoundaryForce(const float &a_arena, const float &a_forceMultiply) {
+    this->m_store->calculateBoundaryForce(this->m_slot, a_arena, a_forceMultiply);
+}
+
+/**
+ * To update the position of the boid using semi-implicit integration.
+ * If the value obtained for the velocity is to high or low, the max/min
+ * values passed in will be used instead respectively.
+ */
+void Boid::updateBoidPosition(const float &a_t,
+                              const float &a_v_min,
+                              const float &a_v_max) {
+    this->m_store->updateBoidPosition(this->m_slot, a_t, a_v_min, a_v_max);
+}
@@ -17,20 +17,24 @@ using namespace givr;
 using namespace givr::geometry;
 
 
+class BoidStore;
+
+
+/**
+ * Lightweight view onto one boid held in a BoidStore. The state itself
+ * lives in the store's columns, a Boid only remembers where to find it.
+ */
 class Boid {
 // public functions
 public:
     ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
-    Boid(unsigned int a_ID,
-         float a_mass,
-         vec3f a_p,
-         vec3f a_v,
-         vec3f a_F);
+    Boid(BoidStore *a_store, unsigned int a_slot);
     ~Boid();
 
 
     //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
     signed int getID() const;
+    unsigned int getSlot() const;
 
     float getMass() const;
     void setMass(const float &a_mass);
@@ -50,9 +54,6 @@ public:
     void setNetForce(const vec3f &a_F);
     void addNetForce(const vec3f &a_F);
 
-    mat4f getModelMat() const;
-    void setModelMat(const mat4f &a_model);
-
     /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
     void calculateBoundaryForce(const float &a_arena, const float &a_forceMultiply);
 
@@ -62,17 +63,8 @@ public:
 
 // private variables
 private:
-    signed int m_ID;
-    float m_mass;
-    vec3f m_p_init;
-    vec3f m_p;
-    vec3f m_v;
-    vec3f m_F; // force accumultor
-    vec3f m_lastForce;
-    mat4f m_model; // model matrix for transformations
-
-    vec3f m_normal;
-
+    BoidStore *m_store; // store holding the boid state
+    unsigned int m_slot; // index of the boid in the store columns
 
 }; // class Boid
 
@@ -0,0 +1,276 @@
+/**
+ * Filename: boidstore.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <cmath>
+#include <utility>
+#include "boidstore.h"
+
+using namespace std;
+using namespace givr;
+
+
+// class: BoidStore
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+BoidStore::BoidStore() {}
+
+BoidStore::~BoidStore() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+unsigned int BoidStore::size() const { return this->m_ID.size(); }
+
+size_t BoidStore::getMemoryUsage() const {
+    return this->m_ID.capacity() * sizeof(signed int) +
+           this->m_mass.capacity() * sizeof(float) +
+           this->m_p.memoryUsage() + this->m_v.memoryUsage() +
+           this->m_F.memoryUsage() + this->m_lastForce.memoryUsage() +
+           this->m_p_init.capacity() * sizeof(vec3f) +
+           this->m_slotOfID.capacity() * sizeof(unsigned int) +
+           this->m_scratch.capacity() * sizeof(float);
+}
+
+Boid BoidStore::at(const unsigned int &a_slot) { return Boid(this, a_slot); }
+
+signed int BoidStore::getID(const unsigned int &a_slot) const { return this->m_ID[a_slot]; }
+
+unsigned int BoidStore::getIDLimit() const { return this->m_slotOfID.size(); }
+
+unsigned int BoidStore::slotOf(const signed int &a_ID) const {
+    if (a_ID < 0 || static_cast<unsigned int>(a_ID) >= this->m_slotOfID.size()) return NO_SLOT;
+    return this->m_slotOfID[a_ID];
+}
+
+float BoidStore::getMass(const unsigned int &a_slot) const { return this->m_mass[a_slot]; }
+void BoidStore::setMass(const unsigned int &a_slot, const float &a_mass) { this->m_mass[a_slot] = a_mass; }
+
+vec3f BoidStore::getInitialPosition(const unsigned int &a_slot) const { return this->m_p_init[a_slot]; }
+
+const signed int *BoidStore::ids() const { return this->m_ID.data(); }
+const float *BoidStore::masses() const { return this->m_mass.data(); }
+const vec3f *BoidStore::initialPositions() const { return this->m_p_init.data(); }
+const unsigned int *BoidStore::slotsOfIDs() const { return this->m_slotOfID.data(); }
+
+Vec3Column &BoidStore::positions() { return this->m_p; }
+const Vec3Column &BoidStore::positions() const { return this->m_p; }
+Vec3Column &BoidStore::velocities() { return this->m_v; }
+const Vec3Column &BoidStore::velocities() const { return this->m_v; }
+Vec3Column &BoidStore::forces() { return this->m_F; }
+const Vec3Column &BoidStore::forces() const { return this->m_F; }
+Vec3Column &BoidStore::lastForces() { return this->m_lastForce; }
+const Vec3Column &BoidStore::lastForces() const { return this->m_lastForce; }
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To append a boid to the end of every column. Returns the slot the boid
+ * was stored in.
+ */
+unsigned int BoidStore::add(unsigned int a_ID,
+                            float a_mass,
+                            vec3f a_p,
+                            vec3f a_v,
+                            vec3f a_F) {
+
+    this->m_ID.push_back(a_ID);
+    this->m_mass.push_back(a_mass);
+    this->m_p.push_back(a_p);
+    this->m_v.push_back(a_v);
+    this->m_F.push_back(a_F);
+    this->m_lastForce.push_back(vec3f(0.0f, 0.0f, 0.0f));
+    this->m_p_init.push_back(a_p);
+
+    unsigned int slot = this->size() - 1;
+    if (a_ID >= this->m_slotOfID.size())
+        this->m_slotOfID.resize(a_ID + 1, NO_SLOT);
+    this->m_slotOfID[a_ID] = slot;
+
+    return slot;
+}
+
+/**
+ * To remove the boid with ID a_ID, if there is one, by moving the boid in
+ * the last slot into its slot. IDs at the top of the range that are no
+ * longer used are given up so add() can hand them out again.
+ */
+void BoidStore::remove(const signed int &a_ID) {
+    unsigned int slot = this->slotOf(a_ID);
+    if (slot == NO_SLOT) return;
+
+    unsigned int last = this->size() - 1;
+    if (slot != last) {
+        for (Vec3Column *column : {&this->m_p, &this->m_v, &this->m_F, &this->m_lastForce})
+            column->set(slot, column->get(last));
+        this->m_mass[slot] = this->m_mass[last];
+        this->m_ID[slot] = this->m_ID[last];
+        this->m_p_init[slot] = this->m_p_init[last];
+        this->m_slotOfID[this->m_ID[slot]] = slot;
+    }
+
+    this->m_ID.pop_back();
+    this->m_mass.pop_back();
+    for (Vec3Column *column : {&this->m_p, &this->m_v, &this->m_F, &this->m_lastForce})
+        column->resize(last);
+    this->m_p_init.pop_back();
+
+    this->m_slotOfID[a_ID] = NO_SLOT;
+    while (!this->m_slotOfID.empty() && this->m_slotOfID.back() == NO_SLOT)
+        this->m_slotOfID.pop_back();
+}
+
+/**
+ * To remove every boid from the store.
+ */
+void BoidStore::clear() {
+    this->m_ID.clear();
+    this->m_mass.clear();
+    this->m_p.clear();
+    this->m_v.clear();
+    this->m_F.clear();
+    this->m_lastForce.clear();
+    this->m_p_init.clear();
+    this->m_slotOfID.clear();
+}
+
+/**
+ * To replace every boid with the ones in a_columns, a copy per column
+ * rather than an add() per boid.
+ */
+void BoidStore::assign(const BoidColumnsView &a_columns) {
+    unsigned int n = a_columns.size;
+    this->m_ID.assign(a_columns.ids, a_columns.ids + n);
+    this->m_mass.assign(a_columns.masses, a_columns.masses + n);
+
+    auto copy = [n](Vec3Column &a_column, const float *const a_from[3]) {
+        a_column.x.assign(a_from[0], a_from[0] + n);
+        a_column.y.assign(a_from[1], a_from[1] + n);
+        a_column.z.assign(a_from[2], a_from[2] + n);
+    };
+    copy(this->m_p, a_columns.positions);
+    copy(this->m_v, a_columns.velocities);
+    copy(this->m_lastForce, a_columns.lastForces);
+    this->m_F.clear();
+    this->m_F.resize(n);
+
+    const vec3f *initial = reinterpret_cast<const vec3f *>(a_columns.initialPositions);
+    static_assert(sizeof(vec3f) == 3 * sizeof(float), "initial positions are copied as packed floats");
+    this->m_p_init.assign(initial, initial + n);
+    this->m_slotOfID.assign(a_columns.slotOfID, a_columns.slotOfID + a_columns.idLimit);
+}
+
+/**
+ * To move every boid to a new slot, the boid in slot a_order[i] ends up in
+ * slot i. a_order has to hold every slot exactly once.
+ */
+void BoidStore::reorder(const vector<unsigned int> &a_order) {
+    unsigned int n = this->size();
+    if (a_order.size() != n) return;
+
+    // gathers one column through the scratch buffer so no column is reallocated
+    AlignedFloats &scratch = this->m_scratch;
+    scratch.resize(n);
+    auto permute = [&](AlignedFloats &a_column) {
+        for (unsigned int i = 0; i < n; i++)
+            scratch[i] = a_column[a_order[i]];
+        a_column.swap(scratch);
+    };
+    for (Vec3Column *column : {&this->m_p, &this->m_v, &this->m_F, &this->m_lastForce}) {
+        permute(column->x);
+        permute(column->y);
+        permute(column->z);
+    }
+    permute(this->m_mass);
+
+    vector<signed int> ids(n);
+    vector<vec3f> initial(n);
+    for (unsigned int i = 0; i < n; i++) {
+        ids[i] = this->m_ID[a_order[i]];
+        initial[i] = this->m_p_init[a_order[i]];
+        this->m_slotOfID[ids[i]] = i;
+    }
+    this->m_ID.swap(ids);
+    this->m_p_init.swap(initial);
+}
+
+/**
+ * To calculate the force of the boundary to apply to the boid in a_slot to
+ * keep it contained.
+ */
+void BoidStore::calculateBoundaryForce(const unsigned int &a_slot,
+                                       const float &a_arena,
+                                       const float &a_forceMultiply) {
+    float px = this->m_p.x[a_slot], py = this->m_p.y[a_slot], pz = this->m_p.z[a_slot];
+    float dist = std::sqrt(px * px + py * py + pz * pz); // from center of arena
+
+    if (dist >= a_arena) { // push boid back in from arena bounds
+        float nx = px / dist, ny = py / dist, nz = pz / dist; // techincally normal vector
+        float vx = this->m_v.x[a_slot], vy = this->m_v.y[a_slot], vz = this->m_v.z[a_slot];
+        float vn = vx * nx + vy * ny + vz * nz;
+        float scale = (dist - a_arena) * a_forceMultiply;
+
+        // normal force plus tangential force
+        this->m_F.x[a_slot] += (-nx + (vx - vn * nx)) * scale;
+        this->m_F.y[a_slot] += (-ny + (vy - vn * ny)) * scale;
+        this->m_F.z[a_slot] += (-nz + (vz - vn * nz)) * scale;
+    }
+}
+
+/**
+ * To apply the boundary force to every boid in the store.
+ */
+void BoidStore::calculateBoundaryForces(const float &a_arena, const float &a_forceMultiply) {
+    for (unsigned int i = 0; i < this->size(); i++)
+        this->calculateBoundaryForce(i, a_arena, a_forceMultiply);
+}
+
+/**
+ * To update the position of the boid in a_slot using semi-implicit
+ * integration. If the value obtained for the velocity is to high or low,
+ * the max/min values passed in will be used instead respectively.
+ */
+void BoidStore::updateBoidPosition(const unsigned int &a_slot,
+                                   const float &a_t,
+                                   const float &a_v_min,
+                                   const float &a_v_max) {
+    float scale = a_t / this->m_mass[a_slot]; // a = F / m
+    float vx = this->m_v.x[a_slot] + this->m_F.x[a_slot] * scale;
+    float vy = this->m_v.y[a_slot] + this->m_F.y[a_slot] * scale;
+    float vz = this->m_v.z[a_slot] + this->m_F.z[a_slot] * scale;
+
+    // check and set velocity
+    float speed = std::sqrt(vx * vx + vy * vy + vz * vz);
+    if (speed < a_v_min || speed > a_v_max) {
+        float clamped = (speed < a_v_min ? a_v_min : a_v_max) / speed;
+        vx *= clamped; vy *= clamped; vz *= clamped;
+    }
+
+    this->m_v.x[a_slot] = vx; // V = V + a(delta_t)
+    this->m_v.y[a_slot] = vy;
+    this->m_v.z[a_slot] = vz;
+    this->m_p.x[a_slot] += vx * a_t; // X = x + v(delta_t)
+    this->m_p.y[a_slot] += vy * a_t;
+    this->m_p.z[a_slot] += vz * a_t;
+
+    // keep track of when force gets cleared and reset the accumulator
+    this->m_lastForce.x[a_slot] = this->m_F.x[a_slot];
+    this->m_lastForce.y[a_slot] = this->m_F.y[a_slot];
+    this->m_lastForce.z[a_slot] = this->m_F.z[a_slot];
+    this->m_F.x[a_slot] = 0.0f;
+    this->m_F.y[a_slot] = 0.0f;
+    this->m_F.z[a_slot] = 0.0f;
+}
+
+/**
+ * To integrate every boid in the store.
+ */
+void BoidStore::updateBoidPositions(const float &a_t,
+                                    const float &a_v_min,
+                                    const float &a_v_max) {
+    for (unsigned int i = 0; i < this->size(); i++)
+        this->updateBoidPosition(i, a_t, a_v_min, a_v_max);
+}
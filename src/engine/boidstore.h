@@ -0,0 +1,196 @@
+/**
+ * Filename: boidstore.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef BOIDSTORE_H
+#define BOIDSTORE_H
+
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "givr.h"
+#include "boid.h"
+
+using namespace std;
+using namespace givr;
+
+
+// alignment of every hot column, wide enough for 256 bit vector loads
+constexpr size_t BOID_COLUMN_ALIGNMENT = 32;
+
+// returned by BoidStore::slotOf for IDs not in the store
+constexpr unsigned int NO_SLOT = ~0u;
+
+
+/**
+ * Allocator handing out memory aligned to Alignment bytes so the columns
+ * of the store can be streamed with aligned vector loads.
+ */
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t a_n) {
+        return static_cast<T*>(::operator new(a_n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T *a_p, size_t) {
+        ::operator delete(a_p, std::align_val_t(Alignment));
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) { return true; }
+template <typename T, typename U, size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) { return false; }
+
+using AlignedFloats = vector<float, AlignedAllocator<float, BOID_COLUMN_ALIGNMENT>>;
+
+
+/**
+ * One vec3f per boid split into three float columns.
+ */
+struct Vec3Column {
+    AlignedFloats x;
+    AlignedFloats y;
+    AlignedFloats z;
+
+    vec3f get(const unsigned int &a_slot) const {
+        return vec3f(x[a_slot], y[a_slot], z[a_slot]);
+    }
+    void set(const unsigned int &a_slot, const vec3f &a_v) {
+        x[a_slot] = a_v.x; y[a_slot] = a_v.y; z[a_slot] = a_v.z;
+    }
+    void add(const unsigned int &a_slot, const vec3f &a_v) {
+        x[a_slot] += a_v.x; y[a_slot] += a_v.y; z[a_slot] += a_v.z;
+    }
+    void push_back(const vec3f &a_v) {
+        x.push_back(a_v.x); y.push_back(a_v.y); z.push_back(a_v.z);
+    }
+    void clear() {
+        x.clear(); y.clear(); z.clear();
+    }
+    void resize(const unsigned int &a_n) { // new entries are zero
+        x.resize(a_n, 0.0f); y.resize(a_n, 0.0f); z.resize(a_n, 0.0f);
+    }
+    unsigned int size() const { return x.size(); }
+    size_t memoryUsage() const { return (x.capacity() + y.capacity() + z.capacity()) * sizeof(float); }
+};
+
+
+/**
+ * Borrowed pointers to every column of a store, for filling one in bulk
+ * (BoidStore::assign) from memory laid out the same way, like a mapped
+ * checkpoint.
+ */
+struct BoidColumnsView {
+    unsigned int size;
+    unsigned int idLimit;
+    const signed int *ids; // size entries each
+    const float *masses;
+    const float *positions[3]; // x, y and z columns
+    const float *velocities[3];
+    const float *lastForces[3];
+    const float *initialPositions; // x, y, z of each boid in turn
+    const unsigned int *slotOfID; // idLimit entries
+};
+
+
+/**
+ * Structure of arrays storage for every boid in the simulation. The state
+ * touched each substep (position, velocity, force, last force, mass, ID)
+ * lives in separate contiguous columns, data only read at startup (the
+ * initial position) is kept apart so it never shares cache lines with it.
+ *
+ * The slot of a boid can change when the store is reordered, its ID never
+ * does; slotOf() finds where a boid with a given ID currently lives.
+ */
+class BoidStore {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    BoidStore();
+    ~BoidStore();
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    unsigned int size() const;
+    size_t getMemoryUsage() const; // bytes held by every column
+    Boid at(const unsigned int &a_slot); // view onto the boid in a_slot
+
+    signed int getID(const unsigned int &a_slot) const;
+    unsigned int slotOf(const signed int &a_ID) const; // NO_SLOT if no boid has the ID
+    unsigned int getIDLimit() const; // every ID in the store is below this
+    float getMass(const unsigned int &a_slot) const;
+    void setMass(const unsigned int &a_slot, const float &a_mass);
+    vec3f getInitialPosition(const unsigned int &a_slot) const;
+
+    const signed int *ids() const;
+    const float *masses() const;
+    const vec3f *initialPositions() const;
+    const unsigned int *slotsOfIDs() const; // getIDLimit() entries, NO_SLOT for unused IDs
+
+    Vec3Column &positions();
+    const Vec3Column &positions() const;
+    Vec3Column &velocities();
+    const Vec3Column &velocities() const;
+    Vec3Column &forces();
+    const Vec3Column &forces() const;
+    Vec3Column &lastForces();
+    const Vec3Column &lastForces() const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    unsigned int add(unsigned int a_ID,
+                     float a_mass,
+                     vec3f a_p,
+                     vec3f a_v,
+                     vec3f a_F);
+    void remove(const signed int &a_ID); // the last boid takes its slot
+    void clear();
+    void assign(const BoidColumnsView &a_columns); // replaces every boid, forces start at zero
+    void reorder(const vector<unsigned int> &a_order); // a_order[new slot] = old slot
+
+    void calculateBoundaryForce(const unsigned int &a_slot,
+                                const float &a_arena,
+                                const float &a_forceMultiply);
+    void calculateBoundaryForces(const float &a_arena, const float &a_forceMultiply);
+
+    void updateBoidPosition(const unsigned int &a_slot,
+                            const float &a_t,
+                            const float &a_v_min,
+                            const float &a_v_max);
+    void updateBoidPositions(const float &a_t,
+                             const float &a_v_min,
+                             const float &a_v_max);
+
+// private variables
+private:
+    // hot data
+    vector<signed int> m_ID;
+    AlignedFloats m_mass;
+    Vec3Column m_p;
+    Vec3Column m_v;
+    Vec3Column m_F; // force accumulator
+    Vec3Column m_lastForce;
+
+    // cold data
+    vector<vec3f> m_p_init;
+    vector<unsigned int> m_slotOfID; // indexed by ID
+
+    // scratch space reused by reorder
+    AlignedFloats m_scratch;
+
+}; // class BoidStore
+
+#endif // BOIDSTORE_H
@@ -0,0 +1,488 @@
+/**
+ * Filename: checkpoint.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include "checkpoint.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHECKPOINT_MMAP 1
+#endif
+
+using namespace std;
+
+
+constexpr char CHECKPOINT_MAGIC[8] = {'B', 'O', 'I', 'D', 'C', 'K', 'P', 'T'};
+constexpr size_t CHECKPOINT_HEADER_SIZE = 64;
+
+// header fields, little-endian at these byte offsets
+constexpr size_t HEADER_VERSION = 8;
+constexpr size_t HEADER_PARAMETER_WORDS = 12;
+constexpr size_t HEADER_FILE_SIZE = 16;
+constexpr size_t HEADER_STEPS = 24;
+constexpr size_t HEADER_BOIDS = 32;
+constexpr size_t HEADER_ID_LIMIT = 36;
+constexpr size_t HEADER_CURVE_BUCKETS = 40;
+constexpr size_t HEADER_MAX_SPEED = 44;
+constexpr size_t HEADER_MAX_TURN_RATE = 48;
+
+// sections after the header, in file order
+enum CheckpointSection {
+    SECTION_PARAMETERS,
+    SECTION_CURVE,
+    SECTION_IDS,
+    SECTION_MASSES,
+    SECTION_POSITION_X, SECTION_POSITION_Y, SECTION_POSITION_Z,
+    SECTION_VELOCITY_X, SECTION_VELOCITY_Y, SECTION_VELOCITY_Z,
+    SECTION_LAST_FORCE_X, SECTION_LAST_FORCE_Y, SECTION_LAST_FORCE_Z,
+    SECTION_INITIAL_POSITIONS,
+    SECTION_SLOTS,
+    SECTION_COUNT
+};
+
+
+/**
+ * To call a_visit on every parameter saved in a checkpoint, in file order.
+ * Adding one means bumping CHECKPOINT_VERSION.
+ */
+template <typename Params, typename Visit>
+static void visitParameters(Params &a_p, Visit &&a_visit) {
+    a_visit(a_p.numBoids);
+    a_visit(a_p.boidMass);
+    a_visit(a_p.minVelocity);
+    a_visit(a_p.maxVelocity);
+    a_visit(a_p.avoidanceRange);
+    a_visit(a_p.avoidanceMultiplier);
+    a_visit(a_p.cohesionRange);
+    a_visit(a_p.cohesionMultiplier);
+    a_visit(a_p.maxSearchRange);
+    a_visit(a_p.gatherMultiplier);
+    a_visit(a_p.arenaRadius);
+    a_visit(a_p.forceMultiplier);
+    a_visit(a_p.neighbourSearch);
+    a_visit(a_p.neighbourSkin);
+    a_visit(a_p.reorderInterval);
+    a_visit(a_p.numThreads);
+    a_visit(a_p.pairKernel);
+    a_visit(a_p.farForceInterval);
+    a_visit(a_p.adaptiveSubsteps);
+    a_visit(a_p.minSubsteps);
+    a_visit(a_p.maxSubsteps);
+    a_visit(a_p.substepTravel);
+    a_visit(a_p.substepTurn);
+    a_visit(a_p.boidFunc);
+}
+
+static uint32_t parameterWordCount() {
+    ProgramParameters params;
+    uint32_t count = 0;
+    visitParameters(params, [&count](auto &) { count++; });
+    delete params.graphValues;
+    return count;
+}
+
+template <typename T>
+static uint32_t toWord(const T &a_value) {
+    if constexpr (is_same<T, float>::value) {
+        uint32_t word;
+        memcpy(&word, &a_value, sizeof(word));
+        return word;
+    } else {
+        return static_cast<uint32_t>(a_value);
+    }
+}
+
+template <typename T>
+static T fromWord(const uint32_t &a_word) {
+    if constexpr (is_same<T, float>::value) {
+        float value;
+        memcpy(&value, &a_word, sizeof(value));
+        return value;
+    } else if constexpr (is_same<T, bool>::value) {
+        return a_word != 0;
+    } else {
+        return static_cast<T>(a_word);
+    }
+}
+
+/**
+ * To check a saved parameter word decodes to a value of its type; only
+ * the enums can be out of range.
+ */
+template <typename T>
+static bool isValidWord(const uint32_t &a_word) {
+    if constexpr (is_same<T, NeighbourSearch>::value)
+        return a_word <= static_cast<uint32_t>(NeighbourSearch::Verlet);
+    else if constexpr (is_same<T, PairKernelType>::value)
+        return a_word <= static_cast<uint32_t>(PairKernelType::AVX2);
+    else
+        return true;
+}
+
+static bool isLittleEndianHost() {
+    const uint16_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+static uint32_t swapWord(uint32_t a_w) {
+    return (a_w >> 24) | ((a_w >> 8) & 0xff00u) | ((a_w << 8) & 0xff0000u) | (a_w << 24);
+}
+
+static void putLE(unsigned char *a_at, uint64_t a_value, const unsigned int &a_bytes) {
+    for (unsigned int i = 0; i < a_bytes; i++)
+        a_at[i] = static_cast<unsigned char>(a_value >> (8 * i));
+}
+
+static uint64_t getLE(const unsigned char *a_at, const unsigned int &a_bytes) {
+    uint64_t value = 0;
+    for (unsigned int i = 0; i < a_bytes; i++)
+        value |= static_cast<uint64_t>(a_at[i]) << (8 * i);
+    return value;
+}
+
+static size_t alignUp(const size_t &a_offset) {
+    return (a_offset + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT * CHECKPOINT_ALIGNMENT;
+}
+
+/**
+ * To get the number of 4 byte words in section a_s.
+ */
+static size_t sectionWords(const unsigned int &a_s,
+                           const uint64_t &a_parameterWords,
+                           const uint64_t &a_curveBuckets,
+                           const uint64_t &a_boids,
+                           const uint64_t &a_idLimit) {
+    if (a_s == SECTION_PARAMETERS) return a_parameterWords;
+    if (a_s == SECTION_CURVE) return a_curveBuckets;
+    if (a_s == SECTION_INITIAL_POSITIONS) return 3 * a_boids;
+    if (a_s == SECTION_SLOTS) return a_idLimit;
+    return a_boids;
+}
+
+/**
+ * To work out where each section starts from the counts in the header;
+ * a_offsets[SECTION_COUNT] is the size of the whole file.
+ */
+static void layoutSections(const uint64_t &a_parameterWords,
+                           const uint64_t &a_curveBuckets,
+                           const uint64_t &a_boids,
+                           const uint64_t &a_idLimit,
+                           size_t a_offsets[SECTION_COUNT + 1]) {
+    size_t offset = CHECKPOINT_HEADER_SIZE;
+    for (unsigned int s = 0; s < SECTION_COUNT; s++) {
+        a_offsets[s] = offset;
+        offset = alignUp(offset + sectionWords(s, a_parameterWords, a_curveBuckets, a_boids, a_idLimit) * sizeof(uint32_t));
+    }
+    a_offsets[SECTION_COUNT] = offset;
+}
+
+
+// class: Checkpoint
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+Checkpoint::Checkpoint() : m_data(nullptr),
+                           m_size(0),
+                           m_mapped(false),
+                           m_steps(0),
+                           m_boidCount(0),
+                           m_idLimit(0),
+                           m_curveBuckets(0),
+                           m_maxSpeed(-1.0f),
+                           m_maxTurnRate(-1.0f) {}
+
+Checkpoint::~Checkpoint() { this->close(); }
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool Checkpoint::isOpen() const { return this->m_data != nullptr; }
+const string &Checkpoint::getError() const { return this->m_error; }
+unsigned int Checkpoint::getBoidCount() const { return this->m_boidCount; }
+unsigned long Checkpoint::getStepCount() const { return this->m_steps; }
+size_t Checkpoint::getFileSize() const { return this->m_size; }
+
+void Checkpoint::getParameters(ProgramParameters &a_params) const {
+    if (!this->isOpen()) return;
+    size_t offsets[SECTION_COUNT + 1];
+    layoutSections(parameterWordCount(), this->m_curveBuckets, this->m_boidCount, this->m_idLimit, offsets);
+
+    const uint32_t *words = reinterpret_cast<const uint32_t *>(this->m_data + offsets[SECTION_PARAMETERS]);
+    visitParameters(a_params, [&words](auto &a_field) {
+        a_field = fromWord<typename decay<decltype(a_field)>::type>(*words++);
+    });
+
+    const float *curve = reinterpret_cast<const float *>(this->m_data + offsets[SECTION_CURVE]);
+    if (a_params.graphValues == nullptr) a_params.graphValues = new vector<float>();
+    a_params.graphValues->assign(curve, curve + this->m_curveBuckets);
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To map a_filename and check it is a whole checkpoint of this version.
+ * Returns false (with the reason in getError) if not.
+ */
+bool Checkpoint::open(const string &a_filename) {
+    this->close();
+    this->m_error.clear();
+
+#ifdef CHECKPOINT_MMAP
+    if (isLittleEndianHost()) {
+        int fd = ::open(a_filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            this->m_error = "could not open " + a_filename;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            this->m_error = a_filename + " is empty";
+            return false;
+        }
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            this->m_error = "could not map " + a_filename;
+            return false;
+        }
+        this->m_data = static_cast<const unsigned char *>(mapped);
+        this->m_size = info.st_size;
+        this->m_mapped = true;
+        return this->validate();
+    }
+#endif
+
+    // no mmap, or the words need swapping: read the whole file
+    ifstream in(a_filename, ios::binary | ios::ate);
+    if (!in) {
+        this->m_error = "could not open " + a_filename;
+        return false;
+    }
+    size_t size = in.tellg();
+    this->m_buffer.assign((size + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+    in.seekg(0);
+    if (size == 0 || !in.read(reinterpret_cast<char *>(this->m_buffer.data()), size)) {
+        this->m_buffer.clear();
+        this->m_error = "could not read " + a_filename;
+        return false;
+    }
+    if (!isLittleEndianHost()) {
+        for (size_t w = CHECKPOINT_HEADER_SIZE / sizeof(uint32_t); w < this->m_buffer.size(); w++)
+            this->m_buffer[w] = swapWord(this->m_buffer[w]);
+    }
+    this->m_data = reinterpret_cast<const unsigned char *>(this->m_buffer.data());
+    this->m_size = size;
+    return this->validate();
+}
+
+/**
+ * To let go of the file.
+ */
+void Checkpoint::close() {
+#ifdef CHECKPOINT_MMAP
+    if (this->m_mapped)
+        munmap(const_cast<unsigned char *>(this->m_data), this->m_size);
+#endif
+    this->m_data = nullptr;
+    this->m_size = 0;
+    this->m_mapped = false;
+    this->m_buffer.clear();
+    this->m_buffer.shrink_to_fit();
+}
+
+/**
+ * To decode the header, check the file is as long as it says and that
+ * what restore() hands on is sound: the enum parameters are in range and
+ * the IDs and slots map one to one, each ID below the limit, so the store
+ * never indexes past its columns. One pass over the IDs and one over the
+ * slots.
+ */
+bool Checkpoint::validate() {
+    const unsigned char *h = this->m_data;
+    string problem;
+    if (this->m_size < CHECKPOINT_HEADER_SIZE || memcmp(h, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0)
+        problem = "not a checkpoint";
+    else if (getLE(h + HEADER_VERSION, 4) != CHECKPOINT_VERSION)
+        problem = "checkpoint version " + to_string(getLE(h + HEADER_VERSION, 4)) +
+                  ", expected " + to_string(CHECKPOINT_VERSION);
+    else if (getLE(h + HEADER_PARAMETER_WORDS, 4) != parameterWordCount())
+        problem = "unexpected parameter count";
+    else if (getLE(h + HEADER_FILE_SIZE, 8) != this->m_size)
+        problem = "truncated checkpoint";
+
+    if (problem.empty()) {
+        this->m_steps = getLE(h + HEADER_STEPS, 8);
+        this->m_boidCount = getLE(h + HEADER_BOIDS, 4);
+        this->m_idLimit = getLE(h + HEADER_ID_LIMIT, 4);
+        this->m_curveBuckets = getLE(h + HEADER_CURVE_BUCKETS, 4);
+        this->m_maxSpeed = fromWord<float>(getLE(h + HEADER_MAX_SPEED, 4));
+        this->m_maxTurnRate = fromWord<float>(getLE(h + HEADER_MAX_TURN_RATE, 4));
+
+        size_t offsets[SECTION_COUNT + 1];
+        layoutSections(parameterWordCount(), this->m_curveBuckets, this->m_boidCount, this->m_idLimit, offsets);
+        if (offsets[SECTION_COUNT] != this->m_size || this->m_idLimit < this->m_boidCount)
+            problem = "sections don't match the header";
+
+        if (problem.empty()) {
+            const uint32_t *words = reinterpret_cast<const uint32_t *>(this->m_data + offsets[SECTION_PARAMETERS]);
+            ProgramParameters params;
+            bool valid = true;
+            visitParameters(params, [&words, &valid](auto &a_field) {
+                valid = valid && isValidWord<typename decay<decltype(a_field)>::type>(*words++);
+            });
+            delete params.graphValues;
+            if (!valid) problem = "parameter out of range";
+        }
+
+        if (problem.empty()) {
+            const signed int *ids = reinterpret_cast<const signed int *>(this->m_data + offsets[SECTION_IDS]);
+            const unsigned int *slots = reinterpret_cast<const unsigned int *>(this->m_data + offsets[SECTION_SLOTS]);
+            // every boid's ID is in range and maps back to its slot, so no two share one...
+            for (unsigned int i = 0; i < this->m_boidCount && problem.empty(); i++) {
+                if (ids[i] < 0 || static_cast<unsigned int>(ids[i]) >= this->m_idLimit || slots[ids[i]] != i)
+                    problem = "boid IDs don't match their slots";
+            }
+            // ...and every slot in use holds the ID pointing at it
+            for (unsigned int id = 0; id < this->m_idLimit && problem.empty(); id++) {
+                unsigned int slot = slots[id];
+                if (slot != NO_SLOT && (slot >= this->m_boidCount || ids[slot] != static_cast<signed int>(id)))
+                    problem = "boid IDs don't match their slots";
+            }
+        }
+    }
+
+    if (!problem.empty()) {
+        this->close();
+        this->m_error = problem;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * To put the checkpoint into a_sim: its boids, curve and substep count and
+ * every parameter but the thread count, which is fixed when the
+ * simulation is made.
+ */
+bool Checkpoint::restore(Simulation &a_sim) const {
+    if (!this->isOpen()) return false;
+    size_t offsets[SECTION_COUNT + 1];
+    layoutSections(parameterWordCount(), this->m_curveBuckets, this->m_boidCount, this->m_idLimit, offsets);
+    auto floats = [&](CheckpointSection a_s) { return reinterpret_cast<const float *>(this->m_data + offsets[a_s]); };
+
+    ProgramParameters params = a_sim.getParameters(); // keeps its graph values
+    const uint32_t *words = reinterpret_cast<const uint32_t *>(this->m_data + offsets[SECTION_PARAMETERS]);
+    visitParameters(params, [&words](auto &a_field) {
+        a_field = fromWord<typename decay<decltype(a_field)>::type>(*words++);
+    });
+    a_sim.setParameters(params);
+    if (this->m_curveBuckets > 0)
+        a_sim.setForceCurve(floats(SECTION_CURVE), this->m_curveBuckets);
+
+    BoidColumnsView columns;
+    columns.size = this->m_boidCount;
+    columns.idLimit = this->m_idLimit;
+    columns.ids = reinterpret_cast<const signed int *>(this->m_data + offsets[SECTION_IDS]);
+    columns.masses = floats(SECTION_MASSES);
+    for (unsigned int axis = 0; axis < 3; axis++) {
+        columns.positions[axis] = floats(CheckpointSection(SECTION_POSITION_X + axis));
+        columns.velocities[axis] = floats(CheckpointSection(SECTION_VELOCITY_X + axis));
+        columns.lastForces[axis] = floats(CheckpointSection(SECTION_LAST_FORCE_X + axis));
+    }
+    columns.initialPositions = floats(SECTION_INITIAL_POSITIONS);
+    columns.slotOfID = reinterpret_cast<const unsigned int *>(this->m_data + offsets[SECTION_SLOTS]);
+    a_sim.getBoids().assign(columns);
+
+    a_sim.restoreState(this->m_steps, this->m_maxSpeed, this->m_maxTurnRate);
+    return true;
+}
+
+/**
+ * To write the state of a_sim to a_filename. It is written next to it first
+ * and renamed over it once complete, so a crash never leaves half of one.
+ */
+bool Checkpoint::save(const Simulation &a_sim, const string &a_filename, string *a_error) {
+    const BoidStore &boids = a_sim.getBoids();
+    const vector<float> &curve = a_sim.getForceCurve();
+    uint32_t n = boids.size(), idLimit = boids.getIDLimit();
+    uint32_t parameterWords = parameterWordCount();
+
+    size_t offsets[SECTION_COUNT + 1];
+    layoutSections(parameterWords, curve.size(), n, idLimit, offsets);
+
+    unsigned char header[CHECKPOINT_HEADER_SIZE] = {};
+    memcpy(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    putLE(header + HEADER_VERSION, CHECKPOINT_VERSION, 4);
+    putLE(header + HEADER_PARAMETER_WORDS, parameterWords, 4);
+    putLE(header + HEADER_FILE_SIZE, offsets[SECTION_COUNT], 8);
+    putLE(header + HEADER_STEPS, a_sim.getStepCount(), 8);
+    putLE(header + HEADER_BOIDS, n, 4);
+    putLE(header + HEADER_ID_LIMIT, idLimit, 4);
+    putLE(header + HEADER_CURVE_BUCKETS, curve.size(), 4);
+    putLE(header + HEADER_MAX_SPEED, toWord(a_sim.getMaxSpeed()), 4);
+    putLE(header + HEADER_MAX_TURN_RATE, toWord(a_sim.getMaxTurnRate()), 4);
+
+    vector<uint32_t> parameters;
+    ProgramParameters params = a_sim.getParameters();
+    visitParameters(params, [&parameters](const auto &a_field) { parameters.push_back(toWord(a_field)); });
+
+    const Vec3Column &p = boids.positions(), &v = boids.velocities(), &f = boids.lastForces();
+    const void *sections[SECTION_COUNT] = {
+        parameters.data(), curve.data(), boids.ids(), boids.masses(),
+        p.x.data(), p.y.data(), p.z.data(),
+        v.x.data(), v.y.data(), v.z.data(),
+        f.x.data(), f.y.data(), f.z.data(),
+        boids.initialPositions(), boids.slotsOfIDs()
+    };
+
+    string temp = a_filename + ".tmp";
+    ofstream out(temp, ios::binary | ios::trunc);
+    if (!out) {
+        if (a_error) *a_error = "could not write " + temp;
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    // every section is 4 byte words, swapped to little-endian if need be
+    bool swap = !isLittleEndianHost();
+    vector<uint32_t> swapped;
+    const char zeros[CHECKPOINT_ALIGNMENT] = {};
+    for (unsigned int s = 0; s < SECTION_COUNT && out; s++) {
+        size_t bytes = offsets[s + 1] - offsets[s];
+        size_t words = sectionWords(s, parameterWords, curve.size(), n, idLimit);
+
+        const char *data = static_cast<const char *>(sections[s]);
+        if (swap && words > 0) {
+            const uint32_t *from = static_cast<const uint32_t *>(sections[s]);
+            swapped.resize(words);
+            for (size_t w = 0; w < words; w++) swapped[w] = swapWord(from[w]);
+            data = reinterpret_cast<const char *>(swapped.data());
+        }
+        if (words > 0) out.write(data, words * sizeof(uint32_t));
+        out.write(zeros, bytes - words * sizeof(uint32_t)); // up to the next section
+    }
+    out.close();
+    if (!out) {
+        remove(temp.c_str());
+        if (a_error) *a_error = "could not write " + temp;
+        return false;
+    }
+    if (rename(temp.c_str(), a_filename.c_str()) != 0) {
+        remove(temp.c_str());
+        if (a_error) *a_error = "could not replace " + a_filename;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * Filename: checkpoint.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+using namespace std;
+
+
+// bumped whenever the layout or the parameter list changes
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+// every section starts on a boundary this wide, so the mapped columns are
+// as aligned as the store's own
+constexpr size_t CHECKPOINT_ALIGNMENT = 64;
+
+
+/**
+ * The full state of a Simulation saved to a file: the boids, the
+ * parameters, the memoized force curve and the substep count, so a run can
+ * be picked up where it left off.
+ *
+ * The file is little-endian and laid out like the store: a 64 byte header,
+ * then the parameters and the curve as 4 byte words and then one section
+ * per column (IDs, masses, position, velocity and last force x/y/z, the
+ * initial positions and the slot of each ID), each starting on a 64 byte
+ * boundary. Opening one maps it into memory and checks it, reading only
+ * the IDs and slots; restoring copies the columns into the store in bulk. On a big-endian machine it is read into memory and swapped instead.
+ */
+class Checkpoint {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    Checkpoint();
+    ~Checkpoint(); // unmaps
+
+    Checkpoint(const Checkpoint &) = delete;
+    Checkpoint &operator=(const Checkpoint &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isOpen() const;
+    const string &getError() const; // why the last open or save failed
+    unsigned int getBoidCount() const;
+    unsigned long getStepCount() const;
+    size_t getFileSize() const;
+    void getParameters(ProgramParameters &a_params) const; // the curve goes into graphValues
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    bool open(const string &a_filename);
+    void close();
+    bool restore(Simulation &a_sim) const; // boids, parameters (not the thread count), curve and step count
+
+    static bool save(const Simulation &a_sim, const string &a_filename, string *a_error = nullptr);
+
+// private functions
+private:
+    bool validate();
+
+// private variables
+private:
+    const unsigned char *m_data; // whole file, mapped or in m_buffer
+    size_t m_size;
+    bool m_mapped;
+    vector<uint32_t> m_buffer; // big-endian machines only
+    string m_error;
+
+    // decoded from the header
+    unsigned long m_steps;
+    unsigned int m_boidCount;
+    unsigned int m_idLimit;
+    unsigned int m_curveBuckets;
+    float m_maxSpeed;
+    float m_maxTurnRate;
+
+}; // class Checkpoint
+
+#endif // CHECKPOINT_H
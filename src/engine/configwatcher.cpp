@@ -0,0 +1,211 @@
+/**
+ * Filename: configwatcher.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <cerrno>
+#include <cstring>
+#include "configwatcher.h"
+#include "tracer.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define CONFIG_INOTIFY 1
+#endif
+
+using namespace std;
+using namespace givr::fileIO;
+
+
+/**
+ * To list the config keys whose values differ between a_from and a_to.
+ */
+static vector<string> changedKeys(const ProgramParameters &a_from, const ProgramParameters &a_to) {
+    vector<string> keys;
+    auto check = [&keys](bool a_changed, const char *a_key) { if (a_changed) keys.push_back(a_key); };
+    check(a_from.numBoids != a_to.numBoids, "boids");
+    check(a_from.boidMass != a_to.boidMass, "mass");
+    check(a_from.avoidanceRange != a_to.avoidanceRange || a_from.cohesionRange != a_to.cohesionRange ||
+          a_from.maxSearchRange != a_to.maxSearchRange, "ACG");
+    check(a_from.avoidanceMultiplier != a_to.avoidanceMultiplier || a_from.cohesionMultiplier != a_to.cohesionMultiplier ||
+          a_from.gatherMultiplier != a_to.gatherMultiplier, "ACG forces");
+    check(a_from.arenaRadius != a_to.arenaRadius, "arena");
+    check(a_from.forceMultiplier != a_to.forceMultiplier, "force");
+    check(a_from.minVelocity != a_to.minVelocity, "min-velocity");
+    check(a_from.maxVelocity != a_to.maxVelocity, "max-velocity");
+    check(a_from.neighbourSearch != a_to.neighbourSearch, "neighbour-search");
+    check(a_from.neighbourSkin != a_to.neighbourSkin, "neighbour-skin");
+    check(a_from.reorderInterval != a_to.reorderInterval, "reorder-interval");
+    check(a_from.numThreads != a_to.numThreads, "threads");
+    check(a_from.pairKernel != a_to.pairKernel, "pair-kernel");
+    check(a_from.farForceInterval != a_to.farForceInterval, "far-force-interval");
+    check(a_from.adaptiveSubsteps != a_to.adaptiveSubsteps, "adaptive-substeps");
+    check(a_from.minSubsteps != a_to.minSubsteps || a_from.maxSubsteps != a_to.maxSubsteps, "substeps");
+    check(a_from.substepTravel != a_to.substepTravel, "substep-travel");
+    check(a_from.substepTurn != a_to.substepTurn, "substep-turn");
+    return keys;
+}
+
+
+// class: ConfigWatcher
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+ConfigWatcher::ConfigWatcher() : m_inotify(-1),
+                                 m_wake{-1, -1},
+                                 m_reloads(0) {
+    // the graph data of a read goes in m_graph, the others never have any
+    for (ProgramParameters *params : {&this->m_current, &this->m_polled, &this->m_pending}) {
+        delete params->graphValues;
+        params->graphValues = nullptr;
+    }
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    this->stop();
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool ConfigWatcher::isWatching() const { return this->m_thread.joinable(); }
+const string &ConfigWatcher::getError() const { return this->m_error; }
+unsigned long ConfigWatcher::getReloadCount() const { return this->m_reloads.load(); }
+
+
+/////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+
+/**
+ * To start watching a_filename, whose current contents a_params was read
+ * from. The directory is watched rather than the file so saves that
+ * replace it (write a new file, rename it over) are seen too. Returns
+ * false if it can't be watched.
+ */
+bool ConfigWatcher::start(const string &a_filename, const ProgramParameters &a_params) {
+    this->stop();
+    this->m_filename = a_filename;
+
+#ifdef CONFIG_INOTIFY
+    string path = configPath(a_filename);
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : path.substr(0, slash + 1);
+    this->m_name = slash == string::npos ? path : path.substr(slash + 1);
+
+    this->m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->m_inotify < 0 ||
+        inotify_add_watch(this->m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+        pipe(this->m_wake) != 0) {
+        this->m_error = "could not watch " + path + ": " + strerror(errno);
+        this->stop();
+        return false;
+    }
+
+    this->m_current = a_params;
+    this->m_current.graphValues = &this->m_graph;
+    {
+        lock_guard<mutex> lock(this->m_mutex);
+        this->m_polled = this->m_current;
+        this->m_changed.clear();
+    }
+    this->m_thread = thread(&ConfigWatcher::run, this);
+    return true;
+#else
+    (void)a_params;
+    this->m_error = "watching config files needs inotify";
+    return false;
+#endif
+}
+
+/**
+ * To stop watching. A reload not polled yet is dropped.
+ */
+void ConfigWatcher::stop() {
+#ifdef CONFIG_INOTIFY
+    if (this->m_thread.joinable()) {
+        char byte = 0;
+        if (write(this->m_wake[1], &byte, 1) != 1) {} // the thread only has to wake
+        this->m_thread.join();
+    }
+    for (int *fd : {&this->m_inotify, &this->m_wake[0], &this->m_wake[1]}) {
+        if (*fd >= 0) ::close(*fd);
+        *fd = -1;
+    }
+#endif
+    lock_guard<mutex> lock(this->m_mutex);
+    this->m_changed.clear();
+}
+
+/**
+ * To copy the last reload over a_params, keeping its graph data and
+ * function, if it changed anything since the last poll. a_changed gets
+ * the keys that did. Returns false, leaving both alone, if there's
+ * nothing new.
+ */
+bool ConfigWatcher::poll(ProgramParameters &a_params, vector<string> &a_changed) {
+    lock_guard<mutex> lock(this->m_mutex);
+    if (this->m_changed.empty()) return false;
+
+    vector<float> *graphValues = a_params.graphValues;
+    int boidFunc = a_params.boidFunc;
+    a_params = this->m_pending;
+    a_params.graphValues = graphValues;
+    a_params.boidFunc = boidFunc;
+    a_changed.swap(this->m_changed);
+    this->m_changed.clear();
+    this->m_polled = this->m_pending;
+    return true;
+}
+
+/**
+ * To wait for the file to be saved, let the burst of events a save makes
+ * settle, and read it again, until stop() writes to the wake pipe.
+ */
+void ConfigWatcher::run() {
+#ifdef CONFIG_INOTIFY
+    Tracer::setThreadName("config");
+
+    alignas(inotify_event) char events[4096];
+    bool saved = false;
+    while (true) {
+        pollfd fds[2] = {{this->m_inotify, POLLIN, 0}, {this->m_wake[0], POLLIN, 0}};
+        int ready = ::poll(fds, 2, saved ? int(CONFIG_SETTLE_MS) : -1);
+        if (ready < 0 && errno != EINTR) break;
+        if (fds[1].revents != 0) break;
+
+        if (ready == 0) { // quiet since the last save
+            this->reload();
+            saved = false;
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(this->m_inotify, events, sizeof(events))) > 0) {
+            for (char *at = events; at < events + length;) {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(at);
+                if (event->len > 0 && this->m_name == event->name) saved = true;
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * To read the file over the values of the last read and hand it to
+ * poll() if it differs from what was last polled.
+ */
+void ConfigWatcher::reload() {
+    TraceZone zone("reload config");
+
+    ProgramParameters read = this->m_current;
+    this->m_graph.clear();
+    if (!parseConfigFile(read, this->m_filename)) return; // mid replace, the next event reads it
+    this->m_current = read;
+
+    lock_guard<mutex> lock(this->m_mutex);
+    this->m_pending = read;
+    this->m_changed = changedKeys(this->m_polled, read);
+    if (!this->m_changed.empty()) this->m_reloads++;
+}
@@ -0,0 +1,89 @@
+/**
+ * Filename: configwatcher.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef CONFIGWATCHER_H
+#define CONFIGWATCHER_H
+
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "parser.h"
+
+using namespace std;
+
+
+// quiet time after a change before the file is read, editors save in bursts
+constexpr unsigned int CONFIG_SETTLE_MS = 50;
+
+
+/**
+ * Watches a config file with inotify and reads it again on a background
+ * thread whenever it is saved, so parameters can be tuned while the
+ * simulation runs. Each read starts from the values of the one before
+ * (or the ones handed to start()), like parseConfigFile, so keys missing
+ * from the file keep their values. The graph data is read but never
+ * handed on, the force curve belongs to the editor.
+ *
+ * poll() is for the thread owning the parameters: it copies the latest
+ * reload over them, if one changed anything since the last poll, and
+ * names the keys that did.
+ */
+class ConfigWatcher {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    ConfigWatcher();
+    ~ConfigWatcher(); // stops watching
+
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isWatching() const;
+    const string &getError() const;
+    unsigned long getReloadCount() const; // reads that changed something
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    // a_filename as handed to parseConfigFile, a_params what it was read into
+    bool start(const string &a_filename, const ProgramParameters &a_params);
+    void stop();
+    bool poll(ProgramParameters &a_params, vector<string> &a_changed); // keeps the graph of a_params
+
+// private functions
+private:
+    void run();
+    void reload();
+
+// private variables
+private:
+    string m_filename;
+    string m_name; // of the file within its directory
+    string m_error;
+    int m_inotify;
+    int m_wake[2]; // pipe, written to by stop()
+    thread m_thread;
+
+    // watching thread only
+    ProgramParameters m_current; // as of the last read
+    vector<float> m_graph; // its graph data, thrown away
+
+    // guarded by m_mutex
+    mutex m_mutex;
+    ProgramParameters m_polled; // as handed out by the last poll
+    ProgramParameters m_pending; // last read
+    vector<string> m_changed; // keys it differs from m_polled in, empty for nothing to poll
+
+    atomic<unsigned long> m_reloads;
+
+}; // class ConfigWatcher
+
+#endif // CONFIGWATCHER_H
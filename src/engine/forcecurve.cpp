@@ -0,0 +1,94 @@
+/**
+ * Filename: forcecurve.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include "forcecurve.h"
+
+using namespace std;
+
+
+// class: ForceCurveExchange
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+ForceCurveExchange::ForceCurveExchange() : m_latest(nullptr),
+                                           m_hazard(nullptr),
+                                           m_version(0) {}
+
+ForceCurveExchange::~ForceCurveExchange() {
+    delete this->m_latest.load();
+    for (ForceCurveVersion *curve : this->m_retired)
+        delete curve;
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+unsigned long ForceCurveExchange::getVersion() const {
+    const ForceCurveVersion *latest = this->m_latest.load(memory_order_acquire);
+    return latest == nullptr ? 0 : latest->version;
+}
+
+unsigned int ForceCurveExchange::getRetiredCount() const { return this->m_retired.size(); }
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To publish a copy of the a_buckets values as the latest version, unless
+ * they are the same as the latest already. Returns the latest version.
+ */
+unsigned long ForceCurveExchange::publish(const float *a_values, const int &a_buckets) {
+    // only this thread swaps or frees versions, so the latest is safe to read
+    const ForceCurveVersion *latest = this->m_latest.load(memory_order_relaxed);
+    if (a_buckets <= 0) return this->m_version;
+    if (latest != nullptr && std::equal(a_values, a_values + a_buckets, latest->values.begin(), latest->values.end()))
+        return this->m_version;
+
+    ForceCurveVersion *curve = new ForceCurveVersion{++this->m_version, vector<float>(a_values, a_values + a_buckets)};
+    ForceCurveVersion *previous = this->m_latest.exchange(curve, memory_order_seq_cst);
+    if (previous != nullptr)
+        this->m_retired.push_back(previous);
+
+    this->reclaim();
+    return this->m_version;
+}
+
+/**
+ * To get the latest version, or null if none has been published. It stays
+ * valid until the next acquire() or release().
+ */
+const ForceCurveVersion *ForceCurveExchange::acquire() {
+    // mark it held, then make sure it wasn't retired before the mark showed
+    ForceCurveVersion *curve = this->m_latest.load(memory_order_seq_cst);
+    ForceCurveVersion *held;
+    do {
+        held = curve;
+        this->m_hazard.store(held, memory_order_seq_cst);
+        curve = this->m_latest.load(memory_order_seq_cst);
+    } while (curve != held);
+
+    return curve;
+}
+
+/**
+ * To let go of the version from acquire().
+ */
+void ForceCurveExchange::release() {
+    this->m_hazard.store(nullptr, memory_order_seq_cst);
+}
+
+/**
+ * To free the retired versions the reader isn't holding.
+ */
+void ForceCurveExchange::reclaim() {
+    ForceCurveVersion *held = this->m_hazard.load(memory_order_seq_cst);
+    auto freed = std::remove_if(this->m_retired.begin(), this->m_retired.end(), [held](ForceCurveVersion *a_curve) {
+        if (a_curve == held) return false;
+        delete a_curve;
+        return true;
+    });
+    this->m_retired.erase(freed, this->m_retired.end());
+}
@@ -0,0 +1,76 @@
+/**
+ * Filename: forcecurve.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef FORCECURVE_H
+#define FORCECURVE_H
+
+
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * One published version of the memoized force curve, never changed once
+ * published.
+ */
+struct ForceCurveVersion {
+    unsigned long version; // counts up from 1
+    vector<float> values;
+};
+
+
+/**
+ * Hands the force curve from the thread editing it to the thread running
+ * the simulation without either one waiting on the other (RCU style). The
+ * writer publishes a new immutable version by swapping a pointer; the
+ * reader picks up whichever is latest when it acquires, at a substep
+ * boundary, and keeps using it until its next acquire.
+ *
+ * There is one writer thread and one reader thread. The reader marks the
+ * version it holds in a hazard pointer and the writer only frees retired
+ * versions the reader isn't holding, so neither side takes a lock.
+ */
+class ForceCurveExchange {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    ForceCurveExchange();
+    ~ForceCurveExchange(); // neither thread may be using it
+
+    ForceCurveExchange(const ForceCurveExchange &) = delete;
+    ForceCurveExchange &operator=(const ForceCurveExchange &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    unsigned long getVersion() const; // latest published, 0 if none
+    unsigned int getRetiredCount() const; // versions the writer hasn't freed yet, writer only
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    // writer
+    unsigned long publish(const float *a_values, const int &a_buckets);
+
+    // reader
+    const ForceCurveVersion *acquire();
+    void release();
+
+// private functions
+private:
+    void reclaim();
+
+// private variables
+private:
+    atomic<ForceCurveVersion *> m_latest; // null until published
+    atomic<ForceCurveVersion *> m_hazard; // held by the reader
+    vector<ForceCurveVersion *> m_retired; // writer only
+    unsigned long m_version; // writer only
+
+}; // class ForceCurveExchange
+
+#endif // FORCECURVE_H
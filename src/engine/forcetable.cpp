@@ -0,0 +1,149 @@
+/**
+ * Filename: forcetable.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "forcetable.h"
+
+using namespace std;
+
+
+/**
+ * Same lookup as MemoizeFunction::evaluate.
+ */
+static inline float evaluateCurve(const float *a_curve, const int &a_buckets, const float &a_t) {
+    int index = std::floor(a_t * a_buckets);
+    if (index >= a_buckets)
+        return a_curve[a_buckets - 1];
+
+    return a_curve[index];
+}
+
+
+// class: ForceTable
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+ForceTable::ForceTable() : m_direction(FORCE_TABLE_BINS + 1, 0.0f),
+                           m_velocity(FORCE_TABLE_BINS + 1, 0.0f),
+                           m_reach(0.0f),
+                           m_binsPerUnit(0.0f) {}
+
+ForceTable::~ForceTable() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+PairKernelParams ForceTable::getKernelParams() const {
+    return {this->m_direction.data(), this->m_velocity.data(), this->m_binsPerUnit, FORCE_TABLE_BINS};
+}
+
+float ForceTable::getReach() const { return this->m_reach; }
+
+size_t ForceTable::getMemoryUsage() const {
+    return (this->m_direction.capacity() + this->m_velocity.capacity()) * sizeof(float);
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To fill the table from the ranges, multipliers and memoized curve. The
+ * cohesion and gather forces are scaled by a_farScale; with it at 0 they
+ * are left out and the table only reaches to avoidance range.
+ */
+void ForceTable::build(const float &a_avoidanceRange,
+                       const float &a_cohesionRange,
+                       const float &a_maxSearchRange,
+                       const float &a_avoidanceMultiplier,
+                       const float &a_cohesionMultiplier,
+                       const float &a_gatherMultiplier,
+                       const float &a_farScale,
+                       const float *a_curve,
+                       const int &a_buckets) {
+    this->m_reach = a_farScale == 0.0f ? a_avoidanceRange : a_maxSearchRange;
+    this->m_binsPerUnit = FORCE_TABLE_BINS / (this->m_reach * this->m_reach);
+
+    for (unsigned int i = 0; i < FORCE_TABLE_BINS; i++) {
+        float dist = std::sqrt((i + 0.5f) / this->m_binsPerUnit);
+        float ratio = 0.0f;
+        float direction = 0.0f, velocity = 0.0f;
+
+        // same bands as the original pair loop
+        if (dist < a_avoidanceRange) {
+            ratio = (dist / a_avoidanceRange) * 0.333;
+            direction = -evaluateCurve(a_curve, a_buckets, ratio) * a_avoidanceMultiplier;
+        } else if (dist < a_cohesionRange) {
+            ratio = (dist / a_cohesionRange) * 0.666;
+            velocity = evaluateCurve(a_curve, a_buckets, ratio) * a_cohesionMultiplier * a_farScale;
+        } else if (dist < a_maxSearchRange) {
+            ratio = (dist / a_maxSearchRange) * 1.0f;
+            direction = evaluateCurve(a_curve, a_buckets, ratio) * a_gatherMultiplier * a_farScale;
+        }
+
+        this->m_direction[i] = direction;
+        this->m_velocity[i] = velocity;
+    }
+    this->m_direction[FORCE_TABLE_BINS] = 0.0f; // past the reach
+    this->m_velocity[FORCE_TABLE_BINS] = 0.0f;
+}
+
+/**
+ * To compare the avoidance force the scalar kernel gets from a table with
+ * the original pair loop's at distances spread evenly over the avoidance
+ * band. Samples whose bin holds more than one curve bucket or band are
+ * counted apart, the table can only be right on one side of the edge.
+ */
+float ForceTable::checkAccuracy(const float &a_avoidanceRange,
+                                const float &a_cohesionRange,
+                                const float &a_maxSearchRange,
+                                const float &a_avoidanceMultiplier,
+                                const float *a_curve,
+                                const int &a_buckets,
+                                const unsigned int &a_samples,
+                                float &a_straddled) {
+    ForceTable table;
+    table.build(a_avoidanceRange, a_cohesionRange, a_maxSearchRange,
+                a_avoidanceMultiplier, 1.0f, 1.0f, 1.0f, a_curve, a_buckets);
+    PairKernelParams params = table.getKernelParams();
+
+    BoidStore boids;
+    boids.add(0, 1.0f, vec3f(0.0f, 0.0f, 0.0f), vec3f(0.0f, 0.0f, 0.0f), vec3f(0.0f, 0.0f, 0.0f));
+    boids.add(1, 1.0f, vec3f(0.0f, 0.0f, 0.0f), vec3f(0.0f, 0.0f, 0.0f), vec3f(0.0f, 0.0f, 0.0f));
+    Vec3Column forces;
+    forces.resize(2);
+    const unsigned int other = 1;
+
+    // the curve bucket a distance falls in, -1 past the avoidance band
+    auto bucketOf = [&](float a_dist) {
+        if (!(a_dist < a_avoidanceRange)) return -1;
+        return std::min(int(std::floor((a_dist / a_avoidanceRange) * 0.333 * a_buckets)), a_buckets - 1);
+    };
+
+    float largest = 0.0f;
+    unsigned int straddled = 0;
+    for (unsigned int k = 0; k < a_samples; k++) {
+        float dist = a_avoidanceRange * (k + 0.5f) / a_samples;
+        float d2 = dist * dist;
+        unsigned int bin = std::min(static_cast<unsigned int>(d2 * params.binsPerUnit), params.bins);
+        float from = std::sqrt(bin / params.binsPerUnit), to = std::sqrt((bin + 1) / params.binsPerUnit);
+        if (bucketOf(from) != bucketOf(std::nextafter(to, 0.0f))) {
+            straddled++;
+            continue;
+        }
+
+        // through the scalar kernel, the other boid along x so the force is its x component
+        boids.positions().set(1, vec3f(dist, 0.0f, 0.0f));
+        forces.set(0, vec3f(0.0f, 0.0f, 0.0f));
+        accumulatePairsScalar(params, boids, forces, 0, &other, 1);
+        float fromTable = forces.x[0];
+        float exact = -evaluateCurve(a_curve, a_buckets, (dist / a_avoidanceRange) * 0.333) *
+                      a_avoidanceMultiplier;
+        float scale = exact != 0.0f ? std::fabs(exact) : a_avoidanceMultiplier;
+        largest = std::max(largest, std::fabs(fromTable - exact) / scale);
+    }
+    a_straddled = a_samples == 0 ? 0.0f : float(straddled) / a_samples;
+    return largest;
+}
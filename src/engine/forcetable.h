@@ -0,0 +1,84 @@
+/**
+ * Filename: forcetable.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef FORCETABLE_H
+#define FORCETABLE_H
+
+
+#include <vector>
+#include "pairkernel.h"
+
+using namespace std;
+
+
+// bins of squared distance in a force table, two tables of two columns
+// stay within 32 KiB
+constexpr unsigned int FORCE_TABLE_BINS = 2048;
+
+
+/**
+ * The boid to boid force as a function of squared distance, so the pair
+ * kernels need no normalize or curve lookup. Bin i covers squared
+ * distances [i, i + 1) / binsPerUnit up to the reach; for each the
+ * direction column holds the avoidance or gather force magnitude (the
+ * kernels multiply it with the offset to the other boid over its length)
+ * and the velocity column the cohesion factor for the velocity
+ * difference. One extra bin past the reach is zero.
+ *
+ * Both only change with the curve bucket and band, so each bin is exact
+ * at any distance within it except where it straddles a bucket or band
+ * edge and takes the value on one side of it. checkAccuracy() measures
+ * that against the exact force.
+ */
+class ForceTable {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    ForceTable();
+    ~ForceTable();
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    PairKernelParams getKernelParams() const; // points into the table
+    float getReach() const;
+    size_t getMemoryUsage() const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    void build(const float &a_avoidanceRange,
+               const float &a_cohesionRange,
+               const float &a_maxSearchRange,
+               const float &a_avoidanceMultiplier,
+               const float &a_cohesionMultiplier,
+               const float &a_gatherMultiplier,
+               const float &a_farScale,
+               const float *a_curve,
+               const int &a_buckets);
+
+    // largest relative error of the avoidance force from the table against
+    // the exact one over a_samples distances spread over the avoidance
+    // band; a_straddled gets the fraction of them in bins straddling a
+    // bucket or band edge, left out of it
+    static float checkAccuracy(const float &a_avoidanceRange,
+                               const float &a_cohesionRange,
+                               const float &a_maxSearchRange,
+                               const float &a_avoidanceMultiplier,
+                               const float *a_curve,
+                               const int &a_buckets,
+                               const unsigned int &a_samples,
+                               float &a_straddled);
+
+// private variables
+private:
+    vector<float> m_direction; // FORCE_TABLE_BINS + 1 entries
+    vector<float> m_velocity;
+    float m_reach;
+    float m_binsPerUnit;
+
+}; // class ForceTable
+
+#endif // FORCETABLE_H
@@ -0,0 +1,242 @@
+/**
+ * Filename: neighbourlist.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include "neighbourlist.h"
+
+using namespace std;
+
+
+// boids handed to a worker at a time while building or checking the lists
+constexpr unsigned int LIST_CHUNK = 256;
+
+
+// class: NeighbourList
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+NeighbourList::NeighbourList() : m_range(0.0f),
+                                 m_skin(0.0f),
+                                 m_valid(false),
+                                 m_rebuilds(0),
+                                 m_reuses(0) {}
+
+NeighbourList::~NeighbourList() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+const unsigned int *NeighbourList::neighbours(const unsigned int &a_slot) const {
+    return this->m_indices.data() + this->m_offsets[a_slot];
+}
+
+unsigned int NeighbourList::count(const unsigned int &a_slot) const {
+    return this->m_offsets[a_slot + 1] - this->m_offsets[a_slot];
+}
+
+unsigned long NeighbourList::getRebuildCount() const { return this->m_rebuilds; }
+unsigned long NeighbourList::getReuseCount() const { return this->m_reuses; }
+
+size_t NeighbourList::getMemoryUsage() const {
+    return (this->m_offsets.capacity() + this->m_indices.capacity()) * sizeof(unsigned int) +
+           this->m_reference.memoryUsage();
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To make sure the lists cover every pair within a_range, rebuilding them
+ * only when they could be missing one. Returns true if they were rebuilt.
+ */
+bool NeighbourList::update(const BoidStore &a_boids,
+                           SpatialGrid &a_grid,
+                           ThreadPool &a_pool,
+                           const float &a_range,
+                           const float &a_skin,
+                           const float &a_extent) {
+    if (!this->isStale(a_boids, a_pool, a_range, a_skin)) {
+        this->m_reuses++;
+        return false;
+    }
+
+    a_grid.rebuild(a_boids, a_range + a_skin, a_extent);
+    this->build(a_boids, a_grid, a_pool, a_range + a_skin);
+
+    this->m_range = a_range;
+    this->m_skin = a_skin;
+    this->m_valid = true;
+    this->m_rebuilds++;
+    return true;
+}
+
+/**
+ * Same as update for a range within a_outerRange, but instead of searching
+ * the grid the lists are filtered out of a_outer (brought up to date for
+ * a_outerRange first), which already holds every pair they could need as
+ * long as a_range plus the skin is within a_outerRange. Past that a_outer
+ * can be missing pairs that close in before these lists go stale, so they
+ * are built from the grid instead.
+ */
+bool NeighbourList::updateWithin(const BoidStore &a_boids,
+                                 NeighbourList &a_outer,
+                                 SpatialGrid &a_grid,
+                                 ThreadPool &a_pool,
+                                 const float &a_range,
+                                 const float &a_outerRange,
+                                 const float &a_skin,
+                                 const float &a_extent) {
+    if (!this->isStale(a_boids, a_pool, a_range, a_skin)) {
+        this->m_reuses++;
+        return false;
+    }
+
+    if (a_range + a_skin <= a_outerRange) {
+        a_outer.update(a_boids, a_grid, a_pool, a_outerRange, a_skin, a_extent);
+        this->filter(a_boids, a_outer, a_pool, a_range + a_skin);
+    } else {
+        a_grid.rebuild(a_boids, a_range + a_skin, a_extent);
+        this->build(a_boids, a_grid, a_pool, a_range + a_skin);
+    }
+
+    this->m_range = a_range;
+    this->m_skin = a_skin;
+    this->m_valid = true;
+    this->m_rebuilds++;
+    return true;
+}
+
+/**
+ * To force a rebuild on the next update, needed when boids change slots.
+ */
+void NeighbourList::invalidate() {
+    this->m_valid = false;
+}
+
+/**
+ * To check if some boid moved more than half the skin since the last
+ * build (two boids closing in on each other from both sides could then
+ * have entered range unseen) or if the setup changed.
+ */
+bool NeighbourList::isStale(const BoidStore &a_boids,
+                            ThreadPool &a_pool,
+                            const float &a_range,
+                            const float &a_skin) {
+    if (!this->m_valid || this->m_reference.size() != a_boids.size() ||
+        this->m_range != a_range || this->m_skin != a_skin)
+        return true;
+
+    const Vec3Column &p = a_boids.positions();
+    const Vec3Column &ref = this->m_reference;
+    this->m_threadMax.assign(a_pool.getThreadCount(), 0.0f);
+
+    a_pool.parallelFor(a_boids.size(), LIST_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int worker) {
+        float largest = this->m_threadMax[worker];
+        for (unsigned int s = begin; s < end; s++) {
+            float dx = p.x[s] - ref.x[s], dy = p.y[s] - ref.y[s], dz = p.z[s] - ref.z[s];
+            largest = std::max(largest, dx * dx + dy * dy + dz * dz);
+        }
+        this->m_threadMax[worker] = largest;
+    }, "list check");
+
+    float halfSkin = 0.5f * a_skin;
+    float largest = *std::max_element(this->m_threadMax.begin(), this->m_threadMax.end());
+    return !(largest <= halfSkin * halfSkin); // a nan position also forces a rebuild
+}
+
+/**
+ * To fill the lists from the grid. One pass counts the neighbours of each
+ * boid so the lists can be laid out back to back, a second fills them.
+ */
+void NeighbourList::build(const BoidStore &a_boids,
+                          SpatialGrid &a_grid,
+                          ThreadPool &a_pool,
+                          const float &a_cutoff) {
+    const Vec3Column &p = a_boids.positions();
+    const signed int *ids = a_boids.ids();
+    const float cutoff2 = a_cutoff * a_cutoff;
+    unsigned int n = a_boids.size();
+
+    // calls a_visit(o) for every lower ID boid within the cutoff of boid s
+    auto forEachInRange = [&](unsigned int s, auto &&a_visit) {
+        float px = p.x[s], py = p.y[s], pz = p.z[s];
+        a_grid.forEachNeighbour(p.get(s), [&](unsigned int o) {
+            if (ids[o] < ids[s]) {
+                float dx = p.x[o] - px, dy = p.y[o] - py, dz = p.z[o] - pz;
+                if (dx * dx + dy * dy + dz * dz < cutoff2)
+                    a_visit(o);
+            }
+        });
+    };
+
+    this->m_offsets.assign(n + 1, 0);
+    a_pool.parallelFor(n, LIST_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int) {
+        for (unsigned int s = begin; s < end; s++) {
+            unsigned int found = 0;
+            forEachInRange(s, [&](unsigned int) { found++; });
+            this->m_offsets[s + 1] = found;
+        }
+    }, "list count");
+
+    for (unsigned int s = 0; s < n; s++)
+        this->m_offsets[s + 1] += this->m_offsets[s];
+
+    this->m_indices.resize(this->m_offsets[n]);
+    a_pool.parallelFor(n, LIST_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int) {
+        for (unsigned int s = begin; s < end; s++) {
+            unsigned int *out = this->m_indices.data() + this->m_offsets[s];
+            forEachInRange(s, [&](unsigned int o) { *out++ = o; });
+        }
+    }, "list fill");
+
+    this->m_reference = p;
+}
+
+/**
+ * To fill the lists with the pairs of a_outer that are within the cutoff,
+ * counting first and filling second like build.
+ */
+void NeighbourList::filter(const BoidStore &a_boids,
+                           const NeighbourList &a_outer,
+                           ThreadPool &a_pool,
+                           const float &a_cutoff) {
+    const Vec3Column &p = a_boids.positions();
+    const float cutoff2 = a_cutoff * a_cutoff;
+    unsigned int n = a_boids.size();
+
+    // calls a_visit(o) for every boid in the outer list of s within the cutoff
+    auto forEachInRange = [&](unsigned int s, auto &&a_visit) {
+        float px = p.x[s], py = p.y[s], pz = p.z[s];
+        const unsigned int *others = a_outer.neighbours(s);
+        for (unsigned int i = 0; i < a_outer.count(s); i++) {
+            unsigned int o = others[i];
+            float dx = p.x[o] - px, dy = p.y[o] - py, dz = p.z[o] - pz;
+            if (dx * dx + dy * dy + dz * dz < cutoff2)
+                a_visit(o);
+        }
+    };
+
+    this->m_offsets.assign(n + 1, 0);
+    a_pool.parallelFor(n, LIST_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int) {
+        for (unsigned int s = begin; s < end; s++) {
+            unsigned int found = 0;
+            forEachInRange(s, [&](unsigned int) { found++; });
+            this->m_offsets[s + 1] = found;
+        }
+    }, "list filter count");
+
+    for (unsigned int s = 0; s < n; s++)
+        this->m_offsets[s + 1] += this->m_offsets[s];
+
+    this->m_indices.resize(this->m_offsets[n]);
+    a_pool.parallelFor(n, LIST_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int) {
+        for (unsigned int s = begin; s < end; s++) {
+            unsigned int *out = this->m_indices.data() + this->m_offsets[s];
+            forEachInRange(s, [&](unsigned int o) { *out++ = o; });
+        }
+    }, "list filter fill");
+
+    this->m_reference = p;
+}
@@ -0,0 +1,95 @@
+/**
+ * Filename: neighbourlist.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef NEIGHBOURLIST_H
+#define NEIGHBOURLIST_H
+
+
+#include <vector>
+#include "boidstore.h"
+#include "spatialgrid.h"
+#include "threadpool.h"
+
+using namespace std;
+
+
+/**
+ * Verlet neighbour lists: for every boid the boids with a lower ID that
+ * were within max search range plus a skin margin when the lists were
+ * built. As long as no boid has moved more than half the skin since then,
+ * every pair within max search range is still in the lists so they can be
+ * reused across substeps instead of searching the grid again.
+ *
+ * The lists are stored back to back (compressed rows), m_offsets[slot]
+ * is where the list of each slot starts.
+ */
+class NeighbourList {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    NeighbourList();
+    ~NeighbourList();
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    const unsigned int *neighbours(const unsigned int &a_slot) const;
+    unsigned int count(const unsigned int &a_slot) const;
+
+    unsigned long getRebuildCount() const;
+    unsigned long getReuseCount() const;
+    size_t getMemoryUsage() const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    bool update(const BoidStore &a_boids,
+                SpatialGrid &a_grid,
+                ThreadPool &a_pool,
+                const float &a_range,
+                const float &a_skin,
+                const float &a_extent);
+    bool updateWithin(const BoidStore &a_boids,
+                      NeighbourList &a_outer,
+                      SpatialGrid &a_grid,
+                      ThreadPool &a_pool,
+                      const float &a_range,
+                      const float &a_outerRange,
+                      const float &a_skin,
+                      const float &a_extent);
+    void invalidate();
+
+// private functions
+private:
+    bool isStale(const BoidStore &a_boids,
+                 ThreadPool &a_pool,
+                 const float &a_range,
+                 const float &a_skin);
+    void build(const BoidStore &a_boids,
+               SpatialGrid &a_grid,
+               ThreadPool &a_pool,
+               const float &a_cutoff);
+    void filter(const BoidStore &a_boids,
+                const NeighbourList &a_outer,
+                ThreadPool &a_pool,
+                const float &a_cutoff);
+
+// private variables
+private:
+    vector<unsigned int> m_offsets; // size boids + 1
+    vector<unsigned int> m_indices; // neighbour slots of every boid
+    Vec3Column m_reference; // positions when the lists were built
+    vector<float> m_threadMax; // largest squared displacement seen by each worker
+
+    float m_range; // max search range the lists were built for
+    float m_skin;
+    bool m_valid;
+
+    unsigned long m_rebuilds; // substeps that rebuilt the lists
+    unsigned long m_reuses; // substeps that reused them
+
+}; // class NeighbourList
+
+#endif // NEIGHBOURLIST_H
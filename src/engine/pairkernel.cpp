@@ -0,0 +1,362 @@
+/**
+ * Filename: pairkernel.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "pairkernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#define PAIR_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PAIR_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PAIR_KERNEL_TARGET(isa)
+#endif
+
+using namespace std;
+
+
+/**
+ * To find the table bin of a pair a_d2 apart, pairs out of reach (and nan
+ * distances) get the zero bin at the end.
+ */
+static inline unsigned int tableBin(const PairKernelParams &a_params, const float &a_d2) {
+    float t = a_d2 * a_params.binsPerUnit;
+    if (!(t < a_params.bins))
+        return a_params.bins;
+
+    return static_cast<unsigned int>(t);
+}
+
+/**
+ * To calculate the force between boid a_b and one other boid, kept as the
+ * reference for the vector versions.
+ */
+static inline void accumulatePair(const PairKernelParams &a_params,
+                                  const BoidStore &a_boids,
+                                  Vec3Column &a_forces,
+                                  const unsigned int &a_b,
+                                  const unsigned int &a_o) {
+    const Vec3Column &p = a_boids.positions();
+    const Vec3Column &v = a_boids.velocities();
+
+    float dx = p.x[a_o] - p.x[a_b], dy = p.y[a_o] - p.y[a_b], dz = p.z[a_o] - p.z[a_b];
+    float d2 = dx * dx + dy * dy + dz * dz;
+    unsigned int bin = tableBin(a_params, d2);
+    if (bin == a_params.bins) return; // at max range or greater
+
+    // avoidance and gather push along the offset, cohesion matches velocity
+    float direction = a_params.direction[bin] / std::sqrt(std::max(d2, PAIR_KERNEL_MIN_D2));
+    float velocity = a_params.velocity[bin];
+    vec3f force(dx * direction + (v.x[a_o] - v.x[a_b]) * velocity,
+                dy * direction + (v.y[a_o] - v.y[a_b]) * velocity,
+                dz * direction + (v.z[a_o] - v.z[a_b]) * velocity);
+
+    // apply forces to each boid respectively
+    a_forces.add(a_b, force);
+    a_forces.add(a_o, -force);
+}
+
+void accumulatePairsScalar(const PairKernelParams &a_params,
+                           const BoidStore &a_boids,
+                           Vec3Column &a_forces,
+                           const unsigned int &a_b,
+                           const unsigned int *a_others,
+                           const unsigned int &a_count) {
+    for (unsigned int i = 0; i < a_count; i++)
+        accumulatePair(a_params, a_boids, a_forces, a_b, a_others[i]);
+}
+
+
+#ifdef PAIR_KERNEL_X86
+
+/**
+ * 4 wide version using SSE2 only. There is no gather so the neighbour
+ * state and table bins are loaded lane by lane.
+ */
+static void accumulatePairsSSE(const PairKernelParams &a_params,
+                               const BoidStore &a_boids,
+                               Vec3Column &a_forces,
+                               const unsigned int &a_b,
+                               const unsigned int *a_others,
+                               const unsigned int &a_count) {
+    const Vec3Column &p = a_boids.positions();
+    const Vec3Column &v = a_boids.velocities();
+    const float *direction = a_params.direction;
+    const float *velocity = a_params.velocity;
+
+    const __m128 bpx = _mm_set1_ps(p.x[a_b]), bpy = _mm_set1_ps(p.y[a_b]), bpz = _mm_set1_ps(p.z[a_b]);
+    const __m128 bvx = _mm_set1_ps(v.x[a_b]), bvy = _mm_set1_ps(v.y[a_b]), bvz = _mm_set1_ps(v.z[a_b]);
+    const __m128 binsPerUnit = _mm_set1_ps(a_params.binsPerUnit);
+    const __m128 bins = _mm_set1_ps(static_cast<float>(a_params.bins));
+    const __m128 minD2 = _mm_set1_ps(PAIR_KERNEL_MIN_D2);
+    const __m128 half = _mm_set1_ps(0.5f), threeHalves = _mm_set1_ps(1.5f);
+
+    __m128 sumX = _mm_setzero_ps(), sumY = _mm_setzero_ps(), sumZ = _mm_setzero_ps();
+    alignas(16) float fx[4], fy[4], fz[4];
+    alignas(16) int idx[4];
+
+    unsigned int i = 0;
+    for (; i + 4 <= a_count; i += 4) {
+        const unsigned int *o = a_others + i;
+
+        __m128 dx = _mm_sub_ps(_mm_set_ps(p.x[o[3]], p.x[o[2]], p.x[o[1]], p.x[o[0]]), bpx);
+        __m128 dy = _mm_sub_ps(_mm_set_ps(p.y[o[3]], p.y[o[2]], p.y[o[1]], p.y[o[0]]), bpy);
+        __m128 dz = _mm_sub_ps(_mm_set_ps(p.z[o[3]], p.z[o[2]], p.z[o[1]], p.z[o[0]]), bpz);
+
+        // min takes the second operand for nan, which is the zero bin
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx), _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(d2, binsPerUnit), bins)));
+        __m128 dirScale = _mm_set_ps(direction[idx[3]], direction[idx[2]], direction[idx[1]], direction[idx[0]]);
+
+        // over the distance, the estimate refined with one newton step (max
+        // takes the second operand for nan, those lanes are in the zero bin)
+        __m128 x = _mm_max_ps(d2, minD2);
+        __m128 y = _mm_rsqrt_ps(x);
+        y = _mm_mul_ps(y, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, x), _mm_mul_ps(y, y))));
+        dirScale = _mm_mul_ps(dirScale, y);
+        __m128 velScale = _mm_set_ps(velocity[idx[3]], velocity[idx[2]], velocity[idx[1]], velocity[idx[0]]);
+
+        __m128 dvx = _mm_sub_ps(_mm_set_ps(v.x[o[3]], v.x[o[2]], v.x[o[1]], v.x[o[0]]), bvx);
+        __m128 dvy = _mm_sub_ps(_mm_set_ps(v.y[o[3]], v.y[o[2]], v.y[o[1]], v.y[o[0]]), bvy);
+        __m128 dvz = _mm_sub_ps(_mm_set_ps(v.z[o[3]], v.z[o[2]], v.z[o[1]], v.z[o[0]]), bvz);
+
+        // avoidance and gather push along the offset, cohesion matches velocity
+        __m128 forceX = _mm_add_ps(_mm_mul_ps(dx, dirScale), _mm_mul_ps(dvx, velScale));
+        __m128 forceY = _mm_add_ps(_mm_mul_ps(dy, dirScale), _mm_mul_ps(dvy, velScale));
+        __m128 forceZ = _mm_add_ps(_mm_mul_ps(dz, dirScale), _mm_mul_ps(dvz, velScale));
+
+        sumX = _mm_add_ps(sumX, forceX);
+        sumY = _mm_add_ps(sumY, forceY);
+        sumZ = _mm_add_ps(sumZ, forceZ);
+
+        // no scatter, hand the opposite force back one lane at a time
+        _mm_store_ps(fx, forceX);
+        _mm_store_ps(fy, forceY);
+        _mm_store_ps(fz, forceZ);
+        for (int l = 0; l < 4; l++) {
+            a_forces.x[o[l]] -= fx[l];
+            a_forces.y[o[l]] -= fy[l];
+            a_forces.z[o[l]] -= fz[l];
+        }
+    }
+
+    _mm_store_ps(fx, sumX);
+    _mm_store_ps(fy, sumY);
+    _mm_store_ps(fz, sumZ);
+    a_forces.x[a_b] += fx[0] + fx[1] + fx[2] + fx[3];
+    a_forces.y[a_b] += fy[0] + fy[1] + fy[2] + fy[3];
+    a_forces.z[a_b] += fz[0] + fz[1] + fz[2] + fz[3];
+
+    // left over pairs
+    accumulatePairsScalar(a_params, a_boids, a_forces, a_b, a_others + i, a_count - i);
+}
+
+/**
+ * 8 wide version of the SSE kernel, the neighbour state and the table
+ * bins are fetched with gathers.
+ */
+PAIR_KERNEL_TARGET("avx2")
+static void accumulatePairsAVX2(const PairKernelParams &a_params,
+                                const BoidStore &a_boids,
+                                Vec3Column &a_forces,
+                                const unsigned int &a_b,
+                                const unsigned int *a_others,
+                                const unsigned int &a_count) {
+    const Vec3Column &p = a_boids.positions();
+    const Vec3Column &v = a_boids.velocities();
+
+    const __m256 bpx = _mm256_set1_ps(p.x[a_b]), bpy = _mm256_set1_ps(p.y[a_b]), bpz = _mm256_set1_ps(p.z[a_b]);
+    const __m256 bvx = _mm256_set1_ps(v.x[a_b]), bvy = _mm256_set1_ps(v.y[a_b]), bvz = _mm256_set1_ps(v.z[a_b]);
+    const __m256 binsPerUnit = _mm256_set1_ps(a_params.binsPerUnit);
+    const __m256 bins = _mm256_set1_ps(static_cast<float>(a_params.bins));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 minD2 = _mm256_set1_ps(PAIR_KERNEL_MIN_D2);
+    const __m256 half = _mm256_set1_ps(0.5f), threeHalves = _mm256_set1_ps(1.5f);
+
+    __m256 sumX = zero, sumY = zero, sumZ = zero;
+    alignas(32) float fx[8], fy[8], fz[8];
+
+    unsigned int i = 0;
+    for (; i + 8 <= a_count; i += 8) {
+        const unsigned int *o = a_others + i;
+        __m256i slots = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(o));
+
+        __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(p.x.data(), slots, 4), bpx);
+        __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(p.y.data(), slots, 4), bpy);
+        __m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(p.z.data(), slots, 4), bpz);
+
+        // min takes the second operand for nan, which is the zero bin
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        __m256 t = _mm256_min_ps(_mm256_mul_ps(d2, binsPerUnit), bins);
+        __m256 inRange = _mm256_cmp_ps(t, bins, _CMP_LT_OQ);
+        if (_mm256_movemask_ps(inRange) == 0) continue; // nothing close enough
+
+        __m256i bin = _mm256_cvttps_epi32(t);
+        __m256 dirScale = _mm256_mask_i32gather_ps(zero, a_params.direction, bin, inRange, 4);
+
+        // over the distance, the estimate refined with one newton step
+        __m256 x = _mm256_max_ps(d2, minD2);
+        __m256 y = _mm256_rsqrt_ps(x);
+        y = _mm256_mul_ps(y, _mm256_sub_ps(threeHalves, _mm256_mul_ps(_mm256_mul_ps(half, x), _mm256_mul_ps(y, y))));
+        dirScale = _mm256_mul_ps(dirScale, y);
+        __m256 velScale = _mm256_mask_i32gather_ps(zero, a_params.velocity, bin, inRange, 4);
+        __m256 inCohesion = _mm256_cmp_ps(velScale, zero, _CMP_NEQ_OQ);
+
+        __m256 dvx = _mm256_sub_ps(_mm256_mask_i32gather_ps(zero, v.x.data(), slots, inCohesion, 4), bvx);
+        __m256 dvy = _mm256_sub_ps(_mm256_mask_i32gather_ps(zero, v.y.data(), slots, inCohesion, 4), bvy);
+        __m256 dvz = _mm256_sub_ps(_mm256_mask_i32gather_ps(zero, v.z.data(), slots, inCohesion, 4), bvz);
+
+        // avoidance and gather push along the offset, cohesion matches velocity
+        __m256 forceX = _mm256_add_ps(_mm256_mul_ps(dx, dirScale), _mm256_mul_ps(dvx, velScale));
+        __m256 forceY = _mm256_add_ps(_mm256_mul_ps(dy, dirScale), _mm256_mul_ps(dvy, velScale));
+        __m256 forceZ = _mm256_add_ps(_mm256_mul_ps(dz, dirScale), _mm256_mul_ps(dvz, velScale));
+
+        sumX = _mm256_add_ps(sumX, forceX);
+        sumY = _mm256_add_ps(sumY, forceY);
+        sumZ = _mm256_add_ps(sumZ, forceZ);
+
+        // no scatter in AVX2, hand the opposite force back to the lanes in range
+        _mm256_store_ps(fx, forceX);
+        _mm256_store_ps(fy, forceY);
+        _mm256_store_ps(fz, forceZ);
+        for (int mask = _mm256_movemask_ps(inRange); mask != 0; mask &= mask - 1) {
+            int l = __builtin_ctz(mask);
+            a_forces.x[o[l]] -= fx[l];
+            a_forces.y[o[l]] -= fy[l];
+            a_forces.z[o[l]] -= fz[l];
+        }
+    }
+
+    _mm256_store_ps(fx, sumX);
+    _mm256_store_ps(fy, sumY);
+    _mm256_store_ps(fz, sumZ);
+    a_forces.x[a_b] += fx[0] + fx[1] + fx[2] + fx[3] + fx[4] + fx[5] + fx[6] + fx[7];
+    a_forces.y[a_b] += fy[0] + fy[1] + fy[2] + fy[3] + fy[4] + fy[5] + fy[6] + fy[7];
+    a_forces.z[a_b] += fz[0] + fz[1] + fz[2] + fz[3] + fz[4] + fz[5] + fz[6] + fz[7];
+
+    // left over pairs
+    accumulatePairsScalar(a_params, a_boids, a_forces, a_b, a_others + i, a_count - i);
+}
+
+#endif // PAIR_KERNEL_X86
+
+
+/**
+ * To check what the cpu can run, unsupported kernels fall back to the
+ * next narrower one.
+ */
+PairKernelType resolvePairKernel(PairKernelType a_type) {
+#ifdef PAIR_KERNEL_X86
+#if defined(__GNUC__) || defined(__clang__)
+    bool hasAVX2 = __builtin_cpu_supports("avx2");
+#else
+    bool hasAVX2 = false;
+#endif
+    if (a_type == PairKernelType::Auto)
+        a_type = PairKernelType::AVX2;
+    if (a_type == PairKernelType::AVX2 && !hasAVX2)
+        a_type = PairKernelType::SSE;
+    return a_type;
+#else
+    (void)a_type;
+    return PairKernelType::Scalar;
+#endif
+}
+
+pair_kernel_t selectPairKernel(PairKernelType a_type) {
+    switch (resolvePairKernel(a_type)) {
+#ifdef PAIR_KERNEL_X86
+        case PairKernelType::AVX2: return accumulatePairsAVX2;
+        case PairKernelType::SSE: return accumulatePairsSSE;
+#endif
+        default: return accumulatePairsScalar;
+    }
+}
+
+const char *pairKernelName(PairKernelType a_type) {
+    switch (a_type) {
+        case PairKernelType::Auto: return "auto";
+        case PairKernelType::Scalar: return "scalar";
+        case PairKernelType::SSE: return "sse";
+        case PairKernelType::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+/**
+ * To run the a_type kernel and the scalar one on the same a_sets random
+ * sets of up to 64 neighbours within a_range (some beyond it, some on top
+ * of the boid) and find the largest relative difference in the forces
+ * they add. Each neighbour gets the force of one pair, which is compared
+ * to the scalar one; the boid gets their sum, added in a different order,
+ * so its difference is taken relative to the sum of their sizes.
+ */
+float comparePairKernel(PairKernelType a_type,
+                        const PairKernelParams &a_params,
+                        const float &a_range,
+                        const unsigned int &a_sets,
+                        const unsigned int &a_seed) {
+    pair_kernel_t kernel = selectPairKernel(a_type);
+    mt19937 generator(a_seed);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    uniform_int_distribution<unsigned int> counts(1, 64);
+    auto random = [&]() { return vec3f(unit(generator), unit(generator), unit(generator)); };
+    auto length = [](const Vec3Column &a_column, const unsigned int &a_slot) {
+        return std::sqrt(a_column.x[a_slot] * a_column.x[a_slot] + a_column.y[a_slot] * a_column.y[a_slot] +
+                         a_column.z[a_slot] * a_column.z[a_slot]);
+    };
+    auto difference = [](const Vec3Column &a_a, const Vec3Column &a_b, const unsigned int &a_slot) {
+        float dx = a_a.x[a_slot] - a_b.x[a_slot], dy = a_a.y[a_slot] - a_b.y[a_slot], dz = a_a.z[a_slot] - a_b.z[a_slot];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    };
+
+    float worst = 0.0f;
+    BoidStore boids;
+    Vec3Column reference, forces;
+    vector<unsigned int> others;
+    for (unsigned int set = 0; set < a_sets; set++) {
+        unsigned int count = counts(generator);
+        boids.clear();
+        vec3f centre = random() * a_range;
+        boids.add(0, 1.0f, centre, random(), vec3f(0.0f));
+        for (unsigned int i = 1; i <= count; i++) {
+            vec3f offset = i == count && set % 8 == 0 ? vec3f(0.0f) : random() * (1.2f * a_range);
+            boids.add(i, 1.0f, centre + offset, random(), vec3f(0.0f));
+        }
+
+        // gathered in no particular order, like the neighbour lists
+        others.resize(count);
+        for (unsigned int i = 0; i < count; i++) others[i] = i + 1;
+        shuffle(others.begin(), others.end(), generator);
+        unsigned int b = 0;
+
+        reference.clear(); reference.resize(count + 1);
+        forces.clear(); forces.resize(count + 1);
+        accumulatePairsScalar(a_params, boids, reference, b, others.data(), count);
+        kernel(a_params, boids, forces, b, others.data(), count);
+
+        // a nan anywhere counts as infinitely far off
+        auto compare = [&](const unsigned int &a_slot, const float &a_size) {
+            float off = difference(forces, reference, a_slot);
+            if (std::isnan(off)) off = INFINITY;
+            if (off > 0.0f) worst = std::max(worst, a_size > 0.0f ? off / a_size : INFINITY);
+        };
+        float pairs = 0.0f; // sum of the sizes of the pair forces
+        for (unsigned int i = 1; i <= count; i++) {
+            float size = length(reference, i);
+            pairs += size;
+            compare(i, size);
+        }
+        compare(b, pairs);
+    }
+    return worst;
+}
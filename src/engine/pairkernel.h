@@ -0,0 +1,82 @@
+/**
+ * Filename: pairkernel.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef PAIRKERNEL_H
+#define PAIRKERNEL_H
+
+
+#include "boidstore.h"
+
+using namespace std;
+
+
+// instruction set used for the boid to boid forces
+enum class PairKernelType {
+    Auto, // widest one the cpu supports
+    Scalar, // one pair at a time, the reference
+    SSE, // 4 pairs at a time
+    AVX2 // 8 pairs at a time
+};
+
+
+// largest relative difference a vector kernel may have from the scalar one
+constexpr float PAIR_KERNEL_TOLERANCE = 1e-5f;
+
+// squared distances are raised to this before taking 1 / distance, so
+// boids on top of each other get no force (their offset is zero) not nan
+constexpr float PAIR_KERNEL_MIN_D2 = 1e-30f;
+
+
+/**
+ * Force tables the pair kernel reads each substep (see ForceTable). A pair
+ * at squared distance d2 uses bin min(d2 * binsPerUnit, bins): direction
+ * is multiplied with the offset to the other boid over its length,
+ * velocity with the difference in velocity. Bin number bins is zero.
+ */
+struct PairKernelParams {
+    const float *direction;
+    const float *velocity;
+    float binsPerUnit;
+    unsigned int bins;
+};
+
+
+/**
+ * Adds the avoidance, cohesion or gather force between boid a_b and each
+ * of the a_count slots in a_others to a_forces (+force on a_b, -force on
+ * the other boid).
+ *
+ * Every version reads the same table bins, the vector versions only sum
+ * in a different order so per pair results match the scalar reference to
+ * within PAIR_KERNEL_TOLERANCE relative error (see comparePairKernel).
+ */
+using pair_kernel_t = void (*)(const PairKernelParams &a_params,
+                               const BoidStore &a_boids,
+                               Vec3Column &a_forces,
+                               const unsigned int &a_b,
+                               const unsigned int *a_others,
+                               const unsigned int &a_count);
+
+void accumulatePairsScalar(const PairKernelParams &a_params,
+                           const BoidStore &a_boids,
+                           Vec3Column &a_forces,
+                           const unsigned int &a_b,
+                           const unsigned int *a_others,
+                           const unsigned int &a_count);
+
+PairKernelType resolvePairKernel(PairKernelType a_type); // falls back when the cpu lacks a_type
+pair_kernel_t selectPairKernel(PairKernelType a_type);
+const char *pairKernelName(PairKernelType a_type);
+
+// largest relative difference between a_type and the scalar kernel over a_sets random neighbour sets
+float comparePairKernel(PairKernelType a_type,
+                        const PairKernelParams &a_params,
+                        const float &a_range,
+                        const unsigned int &a_sets,
+                        const unsigned int &a_seed);
+
+#endif // PAIRKERNEL_H
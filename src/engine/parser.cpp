@@ -20,6 +20,17 @@ using namespace std;
 using namespace givr;
 
 
+/**
+ * Config files are looked up relative to the source tree from the build
+ * folder, absolute paths are used as given.
+ */
+string givr::fileIO::configPath(const string &filename) {
+    if (!filename.empty() && filename[0] == '/')
+        return filename;
+    return "../../" + filename;
+}
+
+
 /**
  * To read in a configuration file and populate the state information based
  * on the values read in.
@@ -38,7 +49,7 @@ bool givr::fileIO::parseConfigFile(struct ProgramParameters &p,
     string line;
 
     try {
-        ifstream iFile("../../" + filename);
+        ifstream iFile(configPath(filename));
 
         if (iFile.is_open()) {
 
@@ -117,6 +128,108 @@ bool givr::fileIO::parseConfigFile(struct ProgramParameters &p,
                             p.maxVelocity = 15.0f;
                         }
 
+                    // NEIGHBOUR SEARCH
+                    } else if (strncmp(line.c_str(), "neighbour-search: ", 18) == 0) {
+                        char method[16];
+                        readValue = sscanf(line.c_str(), "neighbour-search: %15s", method);
+                        if (readValue == 1 && strcmp(method, "brute") == 0) {
+                            p.neighbourSearch = NeighbourSearch::BruteForce;
+                        } else if (readValue == 1 && strcmp(method, "grid") == 0) {
+                            p.neighbourSearch = NeighbourSearch::Grid;
+                        } else if (readValue == 1 && strcmp(method, "verlet") == 0) {
+                            p.neighbourSearch = NeighbourSearch::Verlet;
+                        } else {
+                            cout << "error reading in neighbour search method" << endl;
+                            p.neighbourSearch = NeighbourSearch::Grid;
+                        }
+
+                    // NEIGHBOUR LIST SKIN
+                    } else if (strncmp(line.c_str(), "neighbour-skin: ", 16) == 0) {
+                        readValue = sscanf(line.c_str(), "neighbour-skin: %f", &p.neighbourSkin);
+                        if (readValue != 1 || p.neighbourSkin <= 0.0f) {
+                            cout << "error reading in neighbour skin" << endl;
+                            p.neighbourSkin = 0.5f;
+                        }
+
+                    // REORDER INTERVAL
+                    } else if (strncmp(line.c_str(), "reorder-interval: ", 18) == 0) {
+                        readValue = sscanf(line.c_str(), "reorder-interval: %u", &p.reorderInterval);
+                        if (readValue != 1) {
+                            cout << "error reading in reorder interval" << endl;
+                            p.reorderInterval = 0;
+                        }
+
+                    // WORKER THREADS
+                    } else if (strncmp(line.c_str(), "threads: ", 9) == 0) {
+                        readValue = sscanf(line.c_str(), "threads: %u", &p.numThreads);
+                        if (readValue != 1) {
+                            cout << "error reading in thread count" << endl;
+                            p.numThreads = 0;
+                        }
+
+                    // PAIR KERNEL
+                    } else if (strncmp(line.c_str(), "pair-kernel: ", 13) == 0) {
+                        char kernel[16];
+                        readValue = sscanf(line.c_str(), "pair-kernel: %15s", kernel);
+                        if (readValue == 1 && strcmp(kernel, "scalar") == 0) {
+                            p.pairKernel = PairKernelType::Scalar;
+                        } else if (readValue == 1 && strcmp(kernel, "sse") == 0) {
+                            p.pairKernel = PairKernelType::SSE;
+                        } else if (readValue == 1 && strcmp(kernel, "avx2") == 0) {
+                            p.pairKernel = PairKernelType::AVX2;
+                        } else if (readValue == 1 && strcmp(kernel, "auto") == 0) {
+                            p.pairKernel = PairKernelType::Auto;
+                        } else {
+                            cout << "error reading in pair kernel" << endl;
+                            p.pairKernel = PairKernelType::Auto;
+                        }
+
+                    // FAR FORCE INTERVAL
+                    } else if (strncmp(line.c_str(), "far-force-interval: ", 20) == 0) {
+                        readValue = sscanf(line.c_str(), "far-force-interval: %u", &p.farForceInterval);
+                        if (readValue != 1 || p.farForceInterval == 0) {
+                            cout << "error reading in far force interval" << endl;
+                            p.farForceInterval = 1;
+                        }
+
+                    // ADAPTIVE SUBSTEPS
+                    } else if (strncmp(line.c_str(), "adaptive-substeps: ", 19) == 0) {
+                        char mode[16];
+                        readValue = sscanf(line.c_str(), "adaptive-substeps: %15s", mode);
+                        if (readValue == 1 && strcmp(mode, "on") == 0) {
+                            p.adaptiveSubsteps = true;
+                        } else if (readValue == 1 && strcmp(mode, "off") == 0) {
+                            p.adaptiveSubsteps = false;
+                        } else {
+                            cout << "error reading in adaptive substeps" << endl;
+                            p.adaptiveSubsteps = false;
+                        }
+
+                    // SUBSTEP BOUNDS
+                    } else if (strncmp(line.c_str(), "substeps: ", 10) == 0) {
+                        readValue = sscanf(line.c_str(), "substeps: %u, %u", &p.minSubsteps, &p.maxSubsteps);
+                        if (readValue != 2 || p.minSubsteps == 0 || p.maxSubsteps < p.minSubsteps) {
+                            cout << "error reading in substep bounds" << endl;
+                            p.minSubsteps = 4;
+                            p.maxSubsteps = 32;
+                        }
+
+                    // SUBSTEP TRAVEL
+                    } else if (strncmp(line.c_str(), "substep-travel: ", 16) == 0) {
+                        readValue = sscanf(line.c_str(), "substep-travel: %f", &p.substepTravel);
+                        if (readValue != 1 || p.substepTravel <= 0.0f) {
+                            cout << "error reading in substep travel" << endl;
+                            p.substepTravel = 0.05f;
+                        }
+
+                    // SUBSTEP TURN
+                    } else if (strncmp(line.c_str(), "substep-turn: ", 14) == 0) {
+                        readValue = sscanf(line.c_str(), "substep-turn: %f", &p.substepTurn);
+                        if (readValue != 1 || p.substepTurn <= 0.0f) {
+                            cout << "error reading in substep turn" << endl;
+                            p.substepTurn = 0.1f;
+                        }
+
                     // GRAPH INFORMATION
                     } else if (strncmp(line.c_str(), "total-buckets: ", 15) == 0) { // read in graph data
                         // get number of buckets that should be read in
@@ -189,7 +302,7 @@ bool givr::fileIO::saveConfigFile(struct ProgramParameters &p,
 
     // write information to file
     try {
-        ofstream oFile("../../" + filename);
+        ofstream oFile(configPath(filename));
 
         if (oFile.is_open()) {
 
@@ -239,6 +352,60 @@ bool givr::fileIO::saveConfigFile(struct ProgramParameters &p,
             oFile << "max-velocity: " << p.maxVelocity << "\n\n";
 
 
+            // NEIGHBOUR SEARCH
+            oFile << "# neighbour search method (grid, verlet or brute)\n";
+            oFile << "neighbour-search: ";
+            if (p.neighbourSearch == NeighbourSearch::BruteForce) oFile << "brute";
+            else if (p.neighbourSearch == NeighbourSearch::Verlet) oFile << "verlet";
+            else oFile << "grid";
+            oFile << "\n\n";
+
+
+            // NEIGHBOUR LIST SKIN
+            oFile << "# extra range kept in the verlet neighbour lists\n";
+            oFile << "neighbour-skin: " << p.neighbourSkin << "\n\n";
+
+
+            // REORDER INTERVAL
+            oFile << "# substeps between sorting boids in memory by position (0 never sorts)\n";
+            oFile << "reorder-interval: " << p.reorderInterval << "\n\n";
+
+
+            // WORKER THREADS
+            oFile << "# worker threads for the force calculations (0 uses every core)\n";
+            oFile << "threads: " << p.numThreads << "\n\n";
+
+
+            // PAIR KERNEL
+            oFile << "# instruction set for the boid to boid forces (auto, avx2, sse or scalar)\n";
+            oFile << "pair-kernel: " << pairKernelName(p.pairKernel) << "\n\n";
+
+
+            // FAR FORCE INTERVAL
+            oFile << "# substeps between cohesion/gather force updates (1 updates every substep)\n";
+            oFile << "far-force-interval: " << p.farForceInterval << "\n\n";
+
+
+            // ADAPTIVE SUBSTEPS
+            oFile << "# pick the substeps of each frame from the boid speeds and turns (on or off)\n";
+            oFile << "adaptive-substeps: " << (p.adaptiveSubsteps ? "on" : "off") << "\n\n";
+
+
+            // SUBSTEP BOUNDS
+            oFile << "# fewest and most substeps of an adaptive frame\n";
+            oFile << "substeps: " << p.minSubsteps << ", " << p.maxSubsteps << "\n\n";
+
+
+            // SUBSTEP TRAVEL
+            oFile << "# most a boid may move in a substep, as a fraction of the avoidance range\n";
+            oFile << "substep-travel: " << p.substepTravel << "\n\n";
+
+
+            // SUBSTEP TURN
+            oFile << "# most a boid's velocity may change in a substep, as a fraction of max velocity\n";
+            oFile << "substep-turn: " << p.substepTurn << "\n\n";
+
+
             // GRAPH INFORMATION
             oFile << "# get graph values\n";
             oFile << "total-buckets: " << p.graphValues->size() << "\n"; // total buckets to save
@@ -5,17 +5,30 @@
  * Last Modified: April 1, 2019
  */
 
+#ifndef PARSER_H
+#define PARSER_H
+
+
 #include <stdio.h>
 #include <iostream>
 #include <fstream>
 #include "givr.h"
 #include "glm/gtc/matrix_transform.hpp"
 #include "boid.h"
+#include "pairkernel.h"
 
 using namespace std;
 using namespace givr;
 
 
+// method used to find the boids within search range of each other
+enum class NeighbourSearch {
+    BruteForce, // test every pair of boids
+    Grid, // only test boids in neighbouring cells of a uniform grid
+    Verlet // reuse per boid neighbour lists built from the grid across substeps
+};
+
+
 // struct for storing program specific parameters read in from parser and used throughout
 struct ProgramParameters {
     unsigned int numBoids; // total number of boids
@@ -36,7 +49,19 @@ struct ProgramParameters {
 
     float forceMultiplier; // value to multiply force by
 
-    vector<Boid*> *boids = new vector<Boid*>(); // list storing all of the boids
+    NeighbourSearch neighbourSearch = NeighbourSearch::Grid; // how boid to boid pairs are found
+    float neighbourSkin = 0.5f; // margin past max range kept in the verlet lists
+    unsigned int reorderInterval = 0; // substeps between sorting the boids along a morton curve, 0 never sorts
+    unsigned int numThreads = 0; // worker threads for the force pass, 0 uses every hardware thread
+    PairKernelType pairKernel = PairKernelType::Auto; // instruction set for the boid to boid forces
+    unsigned int farForceInterval = 1; // substeps between cohesion/gather updates, avoidance runs every substep
+
+    bool adaptiveSubsteps = false; // pick the substeps of each frame from how fast the boids move and turn
+    unsigned int minSubsteps = 4; // bounds on the substeps of an adaptive frame
+    unsigned int maxSubsteps = 32;
+    float substepTravel = 0.05f; // most a boid may move in a substep, as a fraction of avoidance range
+    float substepTurn = 0.1f; // most its velocity may change in a substep, as a fraction of max velocity
+
     vector<float> *graphValues = new vector<float>(); // list storing the graph data
 
     int boidFunc; // index value
@@ -52,6 +77,9 @@ namespace fileIO {
                          const string &filename);
     bool saveConfigFile(struct ProgramParameters &p,
                         const string &filename = "config.txt");
+    string configPath(const string &filename); // where the two look for filename
 
 } // namespace io
 } // namespace givr
+
+#endif // PARSER_H
@@ -0,0 +1,56 @@
+/**
+ * Filename: perfcounter.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include "perfcounter.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// class: CacheMissCounter
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+CacheMissCounter::CacheMissCounter() : m_fd(-1) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.inherit = 1; // include threads started from here on
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // this thread, any cpu
+    this->m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+}
+
+CacheMissCounter::~CacheMissCounter() {
+#ifdef __linux__
+    if (this->m_fd >= 0) close(this->m_fd);
+#endif
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool CacheMissCounter::isAvailable() const { return this->m_fd >= 0; }
+
+unsigned long long CacheMissCounter::read() const {
+    unsigned long long count = 0;
+#ifdef __linux__
+    if (this->m_fd < 0 || ::read(this->m_fd, &count, sizeof(count)) != sizeof(count))
+        return 0;
+#endif
+    return count;
+}
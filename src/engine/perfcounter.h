@@ -0,0 +1,42 @@
+/**
+ * Filename: perfcounter.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef PERFCOUNTER_H
+#define PERFCOUNTER_H
+
+
+using namespace std;
+
+
+/**
+ * Counts the last level cache misses of the calling thread and every
+ * thread it starts after the counter was created, so create it before the
+ * simulation spins up its worker pool. Uses perf events on Linux; where
+ * they are missing or not permitted the counter is simply unavailable.
+ */
+class CacheMissCounter {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    CacheMissCounter();
+    ~CacheMissCounter();
+
+    CacheMissCounter(const CacheMissCounter &) = delete;
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isAvailable() const;
+    unsigned long long read() const; // misses counted so far, 0 if unavailable
+
+// private variables
+private:
+    int m_fd;
+
+}; // class CacheMissCounter
+
+#endif // PERFCOUNTER_H
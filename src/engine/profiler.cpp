@@ -0,0 +1,156 @@
+/**
+ * Filename: profiler.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <fstream>
+#include "profiler.h"
+
+using namespace std;
+
+
+// class: Profiler
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+Profiler::Profiler() : m_enabled(false),
+                       m_history(PROFILE_HISTORY),
+                       m_frameNumbers(PROFILE_HISTORY, 0),
+                       m_next(0),
+                       m_frames(0),
+                       m_frameNumber(0) {}
+
+Profiler::~Profiler() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+void Profiler::setEnabled(const bool &a_enabled) {
+    if (a_enabled && !this->isEnabled())
+        this->clear(); // don't mix in frames from before it was turned off
+    this->m_enabled.store(a_enabled);
+}
+
+unsigned int Profiler::getPhaseCount() const {
+    lock_guard<mutex> lock(this->m_mutex);
+    return this->m_names.size();
+}
+
+string Profiler::getPhaseName(const unsigned int &a_phase) const {
+    lock_guard<mutex> lock(this->m_mutex);
+    return this->m_names[a_phase];
+}
+
+unsigned int Profiler::getFrameCount() const {
+    lock_guard<mutex> lock(this->m_mutex);
+    return this->m_frames;
+}
+
+/**
+ * To get the min, average and 99th percentile of a phase over the history.
+ */
+PhaseStats Profiler::getStats(const unsigned int &a_phase) const {
+    lock_guard<mutex> lock(this->m_mutex);
+    PhaseStats stats = {0.0, 0.0, 0.0};
+    if (this->m_frames == 0) return stats;
+
+    vector<double> values(this->m_frames);
+    for (unsigned int f = 0; f < this->m_frames; f++)
+        values[f] = this->frameValue(f, a_phase) * 1000.0;
+
+    stats.min = *std::min_element(values.begin(), values.end());
+    for (double v : values) stats.avg += v;
+    stats.avg /= values.size();
+
+    auto p99 = values.begin() + static_cast<size_t>(0.99 * (values.size() - 1));
+    std::nth_element(values.begin(), p99, values.end());
+    stats.p99 = *p99;
+    return stats;
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To register a phase by name, returning the index used to time it.
+ */
+unsigned int Profiler::addPhase(const string &a_name) {
+    lock_guard<mutex> lock(this->m_mutex);
+    auto found = std::find(this->m_names.begin(), this->m_names.end(), a_name);
+    if (found != this->m_names.end())
+        return found - this->m_names.begin();
+
+    this->m_names.push_back(a_name);
+    this->m_current.resize(this->m_names.size(), 0.0);
+    return this->m_names.size() - 1;
+}
+
+void Profiler::record(const unsigned int &a_phase, const double &a_seconds) {
+    if (a_phase < this->m_current.size())
+        this->m_current[a_phase] += a_seconds;
+}
+
+/**
+ * To start timing a new frame.
+ */
+void Profiler::beginFrame() {
+    std::fill(this->m_current.begin(), this->m_current.end(), 0.0);
+}
+
+/**
+ * To move the timings of the current frame into the history.
+ */
+void Profiler::endFrame() {
+    this->m_frameNumber++;
+    if (!this->isEnabled()) return;
+
+    lock_guard<mutex> lock(this->m_mutex);
+    this->m_history[this->m_next] = this->m_current;
+    this->m_frameNumbers[this->m_next] = this->m_frameNumber;
+    this->m_next = (this->m_next + 1) % PROFILE_HISTORY;
+    this->m_frames = std::min(this->m_frames + 1, PROFILE_HISTORY);
+}
+
+/**
+ * To forget every frame in the history.
+ */
+void Profiler::clear() {
+    lock_guard<mutex> lock(this->m_mutex);
+    this->m_next = 0;
+    this->m_frames = 0;
+}
+
+/**
+ * To write the history out oldest frame first, one row per frame and one
+ * column of milliseconds per phase.
+ */
+bool Profiler::writeCSV(const string &a_filename) const {
+    ofstream oFile(a_filename);
+    if (!oFile.is_open()) return false;
+
+    lock_guard<mutex> lock(this->m_mutex);
+    oFile << "frame";
+    for (const string &name : this->m_names)
+        oFile << "," << name;
+    oFile << "\n";
+
+    for (unsigned int f = 0; f < this->m_frames; f++) {
+        unsigned int entry = (this->m_next + PROFILE_HISTORY - this->m_frames + f) % PROFILE_HISTORY;
+        oFile << this->m_frameNumbers[entry];
+        for (unsigned int p = 0; p < this->m_names.size(); p++)
+            oFile << "," << this->frameValue(f, p) * 1000.0;
+        oFile << "\n";
+    }
+    return true;
+}
+
+/**
+ * To get the seconds spent in a phase in the a_frame'th oldest frame of
+ * the history. Phases added after that frame count as 0.
+ */
+double Profiler::frameValue(const unsigned int &a_frame, const unsigned int &a_phase) const {
+    unsigned int entry = (this->m_next + PROFILE_HISTORY - this->m_frames + a_frame) % PROFILE_HISTORY;
+    const vector<double> &row = this->m_history[entry];
+    return a_phase < row.size() ? row[a_phase] : 0.0;
+}
@@ -0,0 +1,121 @@
+/**
+ * Filename: profiler.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// frames kept for the rolling statistics and the csv dump
+constexpr unsigned int PROFILE_HISTORY = 600;
+
+
+// rolling statistics of one phase, in milliseconds per frame
+struct PhaseStats {
+    double min;
+    double avg;
+    double p99;
+};
+
+
+/**
+ * Per frame timings of named phases. Phases are timed with ProfileScope,
+ * a phase hit several times in a frame (once per substep say) adds up.
+ * The last PROFILE_HISTORY frames are kept for statistics and can be
+ * written out as csv. Phases are added, timed and frames ended by one
+ * thread; the statistics, the csv and the enabled flag can be used from
+ * any other.
+ *
+ * While disabled a ProfileScope does not even read the clock.
+ */
+class Profiler {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    Profiler();
+    ~Profiler();
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isEnabled() const { return this->m_enabled.load(memory_order_relaxed); }
+    void setEnabled(const bool &a_enabled);
+
+    unsigned int getPhaseCount() const;
+    string getPhaseName(const unsigned int &a_phase) const;
+    unsigned int getFrameCount() const; // frames held in the history
+    PhaseStats getStats(const unsigned int &a_phase) const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    unsigned int addPhase(const string &a_name); // index of the phase, reused if the name exists
+    void record(const unsigned int &a_phase, const double &a_seconds);
+
+    void beginFrame();
+    void endFrame();
+    void clear();
+
+    bool writeCSV(const string &a_filename) const;
+
+// private functions
+private:
+    double frameValue(const unsigned int &a_frame, const unsigned int &a_phase) const;
+
+// private variables
+private:
+    atomic<bool> m_enabled;
+    mutable mutex m_mutex; // guards the names and the history
+    vector<string> m_names;
+
+    vector<double> m_current; // seconds per phase in the frame being timed
+    vector<vector<double>> m_history; // ring of finished frames
+    vector<unsigned long> m_frameNumbers; // frame number of each history entry
+    unsigned int m_next; // history entry written next
+    unsigned int m_frames; // history entries in use
+    unsigned long m_frameNumber;
+
+}; // class Profiler
+
+
+/**
+ * Adds the time until it goes out of scope to a phase of the profiler.
+ * Does nothing for a null or disabled profiler.
+ */
+class ProfileScope {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    ProfileScope(Profiler *a_profiler, const unsigned int &a_phase)
+        : m_profiler(a_profiler != nullptr && a_profiler->isEnabled() ? a_profiler : nullptr),
+          m_phase(a_phase) {
+        if (this->m_profiler != nullptr)
+            this->m_start = chrono::steady_clock::now();
+    }
+    ~ProfileScope() {
+        if (this->m_profiler != nullptr)
+            this->m_profiler->record(this->m_phase, chrono::duration<double>(chrono::steady_clock::now() - this->m_start).count());
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+// private variables
+private:
+    Profiler *m_profiler;
+    unsigned int m_phase;
+    chrono::steady_clock::time_point m_start;
+
+}; // class ProfileScope
+
+#endif // PROFILER_H
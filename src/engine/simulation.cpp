@@ -0,0 +1,516 @@
+/**
+ * Filename: simulation.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "simulation.h"
+
+using namespace std;
+using namespace givr;
+
+
+// number of buckets used when the config has no graph values
+constexpr int DEFAULT_BUCKETS = 90;
+
+// bits of each coordinate in a morton key
+constexpr unsigned int MORTON_BITS = 10;
+
+
+/**
+ * To spread the low 10 bits of a_v out so there are two zero bits between
+ * each of them.
+ */
+static unsigned int spreadBits(unsigned int a_v) {
+    a_v &= 0x3ff;
+    a_v = (a_v | (a_v << 16)) & 0x030000ff;
+    a_v = (a_v | (a_v << 8)) & 0x0300f00f;
+    a_v = (a_v | (a_v << 4)) & 0x030c30c3;
+    a_v = (a_v | (a_v << 2)) & 0x09249249;
+    return a_v;
+}
+
+
+// class: Simulation
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+Simulation::Simulation(const ProgramParameters &a_params) : m_params(a_params),
+                                                            m_pool(a_params.numThreads),
+                                                            m_threadForces(m_pool.getThreadCount()),
+                                                            m_threadNeighbours(m_pool.getThreadCount()),
+                                                            m_tablesStale(true),
+                                                            m_curveSource(nullptr),
+                                                            m_curveVersion(0),
+                                                            m_obstacleMode(false),
+                                                            m_maxSpeed(-1.0f),
+                                                            m_maxTurnRate(-1.0f),
+                                                            m_profiler(nullptr),
+                                                            m_phaseNeighbours(0),
+                                                            m_phaseBoundary(0),
+                                                            m_phasePairs(0),
+                                                            m_phaseIntegrate(0),
+                                                            m_steps(0),
+                                                            m_reorders(0) {
+    this->m_pairKernelType = resolvePairKernel(a_params.pairKernel);
+    this->m_pairKernel = selectPairKernel(this->m_pairKernelType);
+
+    // use the graph from the config or a straight line
+    if (a_params.graphValues != nullptr && a_params.graphValues->size() != 0) {
+        this->m_curve = *a_params.graphValues;
+    } else {
+        for (int i = 0; i < DEFAULT_BUCKETS; i++)
+            this->m_curve.push_back(static_cast<float>(i) / DEFAULT_BUCKETS);
+    }
+}
+
+Simulation::~Simulation() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+const ProgramParameters &Simulation::getParameters() const { return this->m_params; }
+void Simulation::setParameters(const ProgramParameters &a_params) {
+    unsigned int threads = this->m_params.numThreads;
+    float mass = this->m_params.boidMass;
+    this->m_params = a_params;
+    this->m_params.numThreads = threads;
+
+    // every boid has the mass from the config, a new one applies to all of them
+    if (a_params.boidMass != mass)
+        for (unsigned int s = 0; s < this->m_boids.size(); s++)
+            this->m_boids.setMass(s, a_params.boidMass);
+
+    this->m_pairKernelType = resolvePairKernel(a_params.pairKernel);
+    this->m_pairKernel = selectPairKernel(this->m_pairKernelType);
+    this->m_tablesStale = true;
+}
+
+BoidStore &Simulation::getBoids() { return this->m_boids; }
+const BoidStore &Simulation::getBoids() const { return this->m_boids; }
+
+unsigned int Simulation::getThreadCount() const { return this->m_pool.getThreadCount(); }
+PairKernelType Simulation::getPairKernel() const { return this->m_pairKernelType; }
+
+bool Simulation::getObstacleMode() const { return this->m_obstacleMode; }
+void Simulation::setObstacleMode(const bool &a_mode) { this->m_obstacleMode = a_mode; }
+void Simulation::addObstacle(const CylinderObstacle &a_obstacle) { this->m_obstacles.push_back(a_obstacle); }
+const vector<CylinderObstacle> &Simulation::getObstacles() const { return this->m_obstacles; }
+
+const vector<float> &Simulation::getForceCurve() const { return this->m_curve; }
+void Simulation::setForceCurve(const float *a_values, const int &a_buckets) {
+    if (a_buckets <= 0 || std::equal(a_values, a_values + a_buckets, this->m_curve.begin(), this->m_curve.end()))
+        return; // handed the same curve every frame, only rebuild the tables for edits
+
+    this->m_curve.assign(a_values, a_values + a_buckets);
+    this->m_tablesStale = true;
+}
+
+void Simulation::setForceCurveSource(ForceCurveExchange *a_source) {
+    if (this->m_curveSource != nullptr)
+        this->m_curveSource->release();
+    this->m_curveSource = a_source;
+    this->m_curveVersion = 0;
+}
+
+unsigned long Simulation::getStepCount() const { return this->m_steps; }
+float Simulation::getMaxSpeed() const { return this->m_maxSpeed; }
+float Simulation::getMaxTurnRate() const { return this->m_maxTurnRate; }
+unsigned long Simulation::getReorderCount() const { return this->m_reorders; }
+const NeighbourList &Simulation::getNeighbourList() const { return this->m_neighbours; }
+const NeighbourList &Simulation::getNearNeighbourList() const { return this->m_nearNeighbours; }
+
+void Simulation::setProfiler(Profiler *a_profiler) {
+    this->m_profiler = a_profiler;
+    if (a_profiler != nullptr) {
+        this->m_phaseNeighbours = a_profiler->addPhase("neighbour search");
+        this->m_phaseBoundary = a_profiler->addPhase("boundary/obstacles");
+        this->m_phasePairs = a_profiler->addPhase("pair forces");
+        this->m_phaseIntegrate = a_profiler->addPhase("integrate");
+    }
+}
+
+size_t Simulation::getMemoryUsage() const {
+    size_t bytes = this->m_boids.getMemoryUsage() + this->m_grid.getMemoryUsage() +
+                   this->m_neighbours.getMemoryUsage() + this->m_nearNeighbours.getMemoryUsage();
+    for (const Vec3Column &forces : this->m_threadForces)
+        bytes += forces.memoryUsage();
+    for (const vector<unsigned int> &others : this->m_threadNeighbours)
+        bytes += others.capacity() * sizeof(unsigned int);
+    bytes += this->m_farTable.getMemoryUsage() + this->m_nearTable.getMemoryUsage();
+    bytes += (this->m_threadMaxSpeed.capacity() + this->m_threadMaxTurn.capacity()) * sizeof(float);
+    bytes += this->m_mortonKeys.capacity() * sizeof(unsigned long long) +
+             this->m_order.capacity() * sizeof(unsigned int);
+    return bytes;
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To replace the flock with numBoids boids at random positions within the
+ * arena, each with a random starting velocity of at most min velocity.
+ */
+void Simulation::spawnBoids(const unsigned int &a_seed) {
+    this->m_boids.clear();
+    this->resizeFlock(this->m_params.numBoids, a_seed);
+}
+
+/**
+ * To grow or shrink the flock to a_count boids without touching the ones
+ * that stay. New boids get the IDs after the highest in use and start
+ * like spawned ones, at random positions within the arena; the boids with
+ * the highest IDs are the ones removed.
+ */
+void Simulation::resizeFlock(const unsigned int &a_count, const unsigned int &a_seed) {
+    BoidStore &boids = this->m_boids;
+    if (boids.size() == a_count) return;
+
+    for (signed int id = signed(boids.getIDLimit()) - 1; id >= 0 && boids.size() > a_count; id--)
+        boids.remove(id);
+
+    mt19937 generator(a_seed);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    while (boids.size() < a_count) {
+        vec3f startPos = vec3f(unit(generator) * this->m_params.arenaRadius,
+                               unit(generator) * this->m_params.arenaRadius,
+                               unit(generator) * this->m_params.arenaRadius);
+        vec3f startVel = vec3f(unit(generator) * this->m_params.minVelocity,
+                               unit(generator) * this->m_params.minVelocity,
+                               unit(generator) * this->m_params.minVelocity);
+        boids.add(boids.getIDLimit(),
+                  this->m_params.boidMass,
+                  startPos,
+                  startVel,
+                  vec3f(0, 0, 0));
+    }
+
+    // the lists hold slots, which were moved or added
+    this->m_neighbours.invalidate();
+    this->m_nearNeighbours.invalidate();
+}
+
+/**
+ * To carry on from a checkpoint: the substep count (which the far force
+ * and reorder intervals go by) and the last frame's measurements, with the
+ * neighbour lists rebuilt for the boids now in the store.
+ */
+void Simulation::restoreState(const unsigned long &a_steps,
+                              const float &a_maxSpeed,
+                              const float &a_maxTurnRate) {
+    this->m_steps = a_steps;
+    this->m_maxSpeed = a_maxSpeed;
+    this->m_maxTurnRate = a_maxTurnRate;
+    this->m_neighbours.invalidate();
+    this->m_nearNeighbours.invalidate();
+}
+
+/**
+ * To run a_steps substeps of a_dt seconds each.
+ */
+void Simulation::advance(const unsigned int &a_steps, const float &a_dt) {
+    for (unsigned int i = 0; i < a_steps; i++)
+        this->step(a_dt);
+}
+
+/**
+ * To pick how many substeps a frame of a_duration seconds needs so that,
+ * going by the last frame, no boid moves more than substepTravel of the
+ * avoidance range or changes its velocity by more than substepTurn of the
+ * max velocity in one. Raw forces aren't used since the velocity clamp
+ * throws most of a large one away.
+ */
+unsigned int Simulation::chooseSubsteps(const float &a_duration) const {
+    const ProgramParameters &params = this->m_params;
+    if (this->m_maxSpeed < 0.0f) return params.maxSubsteps; // nothing measured yet
+
+    float dt = a_duration;
+    if (this->m_maxSpeed > 0.0f)
+        dt = std::min(dt, params.substepTravel * params.avoidanceRange / this->m_maxSpeed);
+    if (this->m_maxTurnRate > 0.0f)
+        dt = std::min(dt, params.substepTurn * params.maxVelocity / this->m_maxTurnRate);
+
+    float substeps = std::ceil(a_duration / dt);
+    if (!(substeps < params.maxSubsteps)) return params.maxSubsteps; // also catches nan
+    return std::max(static_cast<unsigned int>(substeps), params.minSubsteps);
+}
+
+/**
+ * To advance a frame of a_duration seconds, in a_substeps equal substeps
+ * or as many as chooseSubsteps picks with adaptive substeps on. Returns
+ * the substeps taken.
+ */
+unsigned int Simulation::advanceFrame(const float &a_duration, const unsigned int &a_substeps) {
+    if (!this->m_params.adaptiveSubsteps) {
+        this->advance(a_substeps, a_duration / a_substeps);
+        return a_substeps;
+    }
+
+    unsigned int substeps = this->chooseSubsteps(a_duration);
+    this->m_threadMaxSpeed.assign(this->m_pool.getThreadCount(), 0.0f);
+    this->m_threadMaxTurn.assign(this->m_pool.getThreadCount(), 0.0f);
+    float dt = a_duration / substeps;
+    this->advance(substeps, dt);
+
+    // measured for the next frame to go by
+    float speed2 = *std::max_element(this->m_threadMaxSpeed.begin(), this->m_threadMaxSpeed.end());
+    float turn2 = *std::max_element(this->m_threadMaxTurn.begin(), this->m_threadMaxTurn.end());
+    this->m_maxSpeed = std::sqrt(speed2);
+    this->m_maxTurnRate = std::sqrt(turn2) / dt;
+    return substeps;
+}
+
+/**
+ * To sort the boids in memory along a morton (z-order) curve of their
+ * position so boids close together in the arena are close together in the
+ * columns too, keeping the neighbour visits within a few cache lines. IDs
+ * stay the same, only slots change.
+ */
+void Simulation::reorderBoids() {
+    TraceZone zone("morton reorder");
+    BoidStore &boids = this->m_boids;
+    const Vec3Column &p = boids.positions();
+    unsigned int n = boids.size();
+
+    // quantize the arena (and a max range around it) into 2^10 steps per axis
+    float extent = this->m_params.arenaRadius + this->m_params.maxSearchRange;
+    float scale = ((1 << MORTON_BITS) - 1) / (2.0f * extent);
+    auto quantize = [&](float a_x) {
+        float q = (a_x + extent) * scale;
+        return static_cast<unsigned int>(std::min(std::max(q, 0.0f), float((1 << MORTON_BITS) - 1)));
+    };
+
+    // key in the high bits, slot in the low bits so equal keys keep their order
+    this->m_mortonKeys.resize(n);
+    for (unsigned int s = 0; s < n; s++) {
+        unsigned long long key = spreadBits(quantize(p.x[s])) |
+                                 (spreadBits(quantize(p.y[s])) << 1) |
+                                 (spreadBits(quantize(p.z[s])) << 2);
+        this->m_mortonKeys[s] = (key << 32) | s;
+    }
+    std::sort(this->m_mortonKeys.begin(), this->m_mortonKeys.end());
+
+    this->m_order.resize(n);
+    for (unsigned int i = 0; i < n; i++)
+        this->m_order[i] = static_cast<unsigned int>(this->m_mortonKeys[i] & 0xffffffffull);
+    boids.reorder(this->m_order);
+
+    // the lists hold slots, which just moved
+    this->m_neighbours.invalidate();
+    this->m_nearNeighbours.invalidate();
+    this->m_reorders++;
+}
+
+/**
+ * To calculate the forces on every boid and integrate them over a_dt.
+ */
+void Simulation::step(const float &a_dt) {
+    TraceZone zone("step");
+    const ProgramParameters &params = this->m_params;
+    BoidStore &boids = this->m_boids;
+
+    // one force accumulator per worker so no two threads write the same boid
+    for (Vec3Column &forces : this->m_threadForces)
+        if (forces.size() != boids.size())
+            forces.resize(boids.size());
+
+    // multiple time stepping: the stiff avoidance band is calculated every substep, the slow
+    // cohesion and gather bands every farForceInterval substeps as an impulse covering all of them
+    unsigned int interval = std::max(params.farForceInterval, 1u);
+    bool farStep = this->m_steps % interval == 0;
+    float searchRange = farStep ? params.maxSearchRange : params.avoidanceRange;
+    const NeighbourList &lists = farStep ? this->m_neighbours : this->m_nearNeighbours;
+
+    // take up the latest published force curve between substeps, the one held stays valid until the next
+    if (this->m_curveSource != nullptr) {
+        const ForceCurveVersion *curve = this->m_curveSource->acquire();
+        if (curve != nullptr && curve->version != this->m_curveVersion) {
+            this->m_curveVersion = curve->version;
+            this->setForceCurve(curve->values.data(), curve->values.size());
+        }
+    }
+
+    // force tables from the current ranges, multipliers and force curve for the pair kernel
+    if (this->m_tablesStale)
+        this->buildForceTables();
+    PairKernelParams kernelParams = farStep ? this->m_farTable.getKernelParams() : this->m_nearTable.getKernelParams();
+
+    // sort the boids in memory now and then, bin them so each one only visits the cells around it
+    float extent = params.arenaRadius + params.maxSearchRange;
+    {
+        ProfileScope scope(this->m_profiler, this->m_phaseNeighbours);
+        TraceZone zone("neighbour search");
+        if (params.reorderInterval != 0 && this->m_steps % params.reorderInterval == 0)
+            this->reorderBoids();
+
+        if (params.neighbourSearch == NeighbourSearch::Grid)
+            this->m_grid.rebuild(boids, searchRange, extent);
+        else if (params.neighbourSearch == NeighbourSearch::Verlet && farStep)
+            this->m_neighbours.update(boids, this->m_grid, this->m_pool, params.maxSearchRange, params.neighbourSkin, extent);
+        else if (params.neighbourSearch == NeighbourSearch::Verlet)
+            this->m_nearNeighbours.updateWithin(boids, this->m_neighbours, this->m_grid, this->m_pool,
+                                                params.avoidanceRange, params.maxSearchRange, params.neighbourSkin, extent);
+    }
+
+    // go through each boid and calculate personal forces, only one worker writes to boid s directly
+    {
+        ProfileScope scope(this->m_profiler, this->m_phaseBoundary);
+        this->m_pool.parallelFor(boids.size(), WORK_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int) {
+            for (unsigned int s = begin; s < end; s++) {
+                Boid b = boids.at(s);
+                b.calculateBoundaryForce(params.arenaRadius, params.forceMultiplier);
+
+                if (this->m_obstacleMode)
+                    this->calculateObstacleForce(b, a_dt);
+            }
+        }, "boundary/obstacles");
+    }
+
+    // calculate boid to boid interactions, split across the workers
+    {
+        ProfileScope scope(this->m_profiler, this->m_phasePairs);
+        this->m_pool.parallelFor(boids.size(), WORK_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int worker) {
+            Vec3Column &forces = this->m_threadForces[worker]; // pair forces from this worker
+            vector<unsigned int> &others = this->m_threadNeighbours[worker];
+            const signed int *ids = boids.ids();
+
+            for (unsigned int s = begin; s < end; s++) {
+                if (params.neighbourSearch == NeighbourSearch::Verlet) {
+                    this->m_pairKernel(kernelParams, boids, forces, s, lists.neighbours(s), lists.count(s));
+                    continue;
+                }
+
+                others.clear();
+                if (params.neighbourSearch == NeighbourSearch::Grid) {
+                    this->m_grid.forEachNeighbour(boids.positions().get(s), [&](unsigned int o) {
+                        if (ids[o] < ids[s])
+                            others.push_back(o);
+                    });
+                } else {
+                    for (unsigned int o = 0; o < boids.size(); o++) // N^2 version
+                        if (ids[o] < ids[s])
+                            others.push_back(o);
+                }
+                this->m_pairKernel(kernelParams, boids, forces, s, others.data(), others.size());
+            }
+        }, "pair forces");
+    }
+
+    // go through each boid, gather the per thread forces and update positions
+    ProfileScope scope(this->m_profiler, this->m_phaseIntegrate);
+    bool measure = params.adaptiveSubsteps && this->m_threadMaxSpeed.size() == this->m_pool.getThreadCount();
+    bool measureTurn = !farStep || interval == 1; // far force impulses turn the boids on purpose
+    this->m_pool.parallelFor(boids.size(), WORK_CHUNK, [&](unsigned int begin, unsigned int end, unsigned int worker) {
+        Vec3Column &net = boids.forces();
+        for (Vec3Column &forces : this->m_threadForces) {
+            for (unsigned int s = begin; s < end; s++) {
+                net.x[s] += forces.x[s]; forces.x[s] = 0.0f;
+                net.y[s] += forces.y[s]; forces.y[s] = 0.0f;
+                net.z[s] += forces.z[s]; forces.z[s] = 0.0f;
+            }
+        }
+
+        if (!measure) {
+            for (unsigned int s = begin; s < end; s++)
+                boids.updateBoidPosition(s, a_dt, params.minVelocity, params.maxVelocity);
+            return;
+        }
+
+        // keep the largest speed and velocity change for the next frame's substeps
+        Vec3Column &v = boids.velocities();
+        float speed2 = this->m_threadMaxSpeed[worker];
+        float turn2 = this->m_threadMaxTurn[worker];
+        for (unsigned int s = begin; s < end; s++) {
+            float vx = v.x[s], vy = v.y[s], vz = v.z[s];
+            boids.updateBoidPosition(s, a_dt, params.minVelocity, params.maxVelocity);
+            float dx = v.x[s] - vx, dy = v.y[s] - vy, dz = v.z[s] - vz;
+            speed2 = std::max(speed2, v.x[s] * v.x[s] + v.y[s] * v.y[s] + v.z[s] * v.z[s]);
+            if (measureTurn)
+                turn2 = std::max(turn2, dx * dx + dy * dy + dz * dz);
+        }
+        this->m_threadMaxSpeed[worker] = speed2;
+        this->m_threadMaxTurn[worker] = turn2;
+    }, "integrate");
+
+    this->m_steps++;
+}
+
+/**
+ * To rebuild the force tables of the pair kernel after the curve or the
+ * parameters changed.
+ */
+void Simulation::buildForceTables() {
+    const ProgramParameters &params = this->m_params;
+    const float *curve = this->m_curve.data();
+    int buckets = this->m_curve.size();
+    float farScale = static_cast<float>(std::max(params.farForceInterval, 1u));
+
+    this->m_farTable.build(params.avoidanceRange, params.cohesionRange, params.maxSearchRange,
+                           params.avoidanceMultiplier, params.cohesionMultiplier, params.gatherMultiplier,
+                           farScale, curve, buckets);
+    this->m_nearTable.build(params.avoidanceRange, params.cohesionRange, params.maxSearchRange,
+                            params.avoidanceMultiplier, params.cohesionMultiplier, params.gatherMultiplier,
+                            0.0f, curve, buckets);
+    this->m_tablesStale = false;
+}
+
+/**
+ * To steer the boid around every obstacle it is about to fly into.
+ */
+void Simulation::calculateObstacleForce(Boid &a_b, const float &a_dt) {
+    const ProgramParameters &params = this->m_params;
+
+    // test for object collisions
+    for (const CylinderObstacle &o : this->m_obstacles) {
+        vec3f cylinderOrigin = (o.p1 + o.p2) * 0.5f; // get the midway vector
+
+        vec3f nextPos = a_b.getPosition() + a_b.getVelocity() * a_dt; // look ahead
+        vec3f currVel = a_b.getVelocity();
+        vec2f testPos = vec2f(nextPos.x, nextPos.y) -
+                        vec2f(cylinderOrigin.x, cylinderOrigin.y);
+        vec2f testVel = vec2f(currVel.x, currVel.y);
+        float r = o.radius + (params.maxSearchRange * 0.3f);
+
+        float A = dot(testVel, testVel);
+        float B = 2 * dot(testVel, testPos);
+        float C = dot(testPos, testPos) - (r * r);
+
+        float descriminant = (B * B) - (4 * A * C);
+        float denominator = 0.0f;
+        float t = 0.0f, t1 = 0.0f, t2 = 0.0f;
+
+        if (descriminant >= 0) { // one or more solutions
+            if (descriminant == 0) {
+                t = -B / (2 * A);
+            } else {
+                descriminant = sqrt(descriminant);
+                denominator = -B - descriminant;
+                if (denominator != 0) t1 = denominator / (2 * A);
+                denominator = -B + descriminant;
+                if (denominator != 0) t2 = denominator / (2 * A);
+
+                // take the larger of the smaller of the two
+                t = t1 < t2 ? t1 : t2;
+            }
+            // if collision detected, calculate force to apply to the boid
+            if (t > 0.0) {
+                // plug back into x + tv to give point in 3d where it intersects
+                vec3f intersect = a_b.getPosition() + t * a_b.getVelocity(); // intersect point
+
+                // calculate normal and tangential force
+                vec3f resultant = vec3f(0.0f, 0.0f, 0.0f);
+                vec3f normal = vec3f(intersect.x, intersect.y, 0.0f) - vec3f(cylinderOrigin.x, cylinderOrigin.y, 0.0f);
+                normal = glm::normalize(normal);
+                resultant += normal * params.forceMultiplier;
+
+                vec3f tangent = a_b.getVelocity() - (glm::dot(a_b.getVelocity(), normal) * normal);
+                tangent = glm::normalize(tangent);
+                resultant += tangent * params.forceMultiplier;
+
+                a_b.addNetForce(resultant);
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * Filename: simulation.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+
+#include <vector>
+#include "givr.h"
+#include "boidstore.h"
+#include "forcecurve.h"
+#include "forcetable.h"
+#include "neighbourlist.h"
+#include "pairkernel.h"
+#include "parser.h"
+#include "profiler.h"
+#include "spatialgrid.h"
+#include "threadpool.h"
+#include "tracer.h"
+
+using namespace std;
+using namespace givr;
+
+
+// GLOBAL CONSTANTS
+constexpr float DELTA_T = 0.001;   // seconds (time step) 0.05
+constexpr unsigned int INTEGRATION = 16; // number of integrations per frame
+constexpr unsigned int WORK_CHUNK = 64; // boids handed to a worker at a time
+
+
+// cylinder to fly around, boids treat it as infinite along z through the middle of p1 and p2
+struct CylinderObstacle {
+    vec3f p1;
+    vec3f p2;
+    float radius;
+};
+
+
+/**
+ * The flocking simulation without any rendering: the boid state, the
+ * neighbour search and the worker pool used to calculate the forces.
+ * Used by the viewer as well as the headless tools.
+ */
+class Simulation {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    Simulation(const ProgramParameters &a_params);
+    ~Simulation();
+
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    const ProgramParameters &getParameters() const;
+    void setParameters(const ProgramParameters &a_params); // thread count is fixed at construction
+
+    BoidStore &getBoids();
+    const BoidStore &getBoids() const;
+
+    unsigned int getThreadCount() const;
+    PairKernelType getPairKernel() const; // kernel actually in use
+
+    bool getObstacleMode() const;
+    void setObstacleMode(const bool &a_mode);
+    void addObstacle(const CylinderObstacle &a_obstacle);
+    const vector<CylinderObstacle> &getObstacles() const;
+
+    const vector<float> &getForceCurve() const;
+    void setForceCurve(const float *a_values, const int &a_buckets);
+    void setForceCurveSource(ForceCurveExchange *a_source); // picked up at every substep, null for none
+
+    unsigned long getStepCount() const;
+    float getMaxSpeed() const; // over the substeps of the last frame, adaptive substeps only
+    float getMaxTurnRate() const; // largest velocity change per second, same
+    unsigned long getReorderCount() const;
+    const NeighbourList &getNeighbourList() const;
+    const NeighbourList &getNearNeighbourList() const; // avoidance range only, between far force updates
+    size_t getMemoryUsage() const; // bytes held for the boids and the force pass
+
+    void setProfiler(Profiler *a_profiler); // times the phases of each step, null stops timing
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    void spawnBoids(const unsigned int &a_seed);
+    void resizeFlock(const unsigned int &a_count, const unsigned int &a_seed); // adds or removes boids, the rest carry on
+
+    void restoreState(const unsigned long &a_steps,
+                      const float &a_maxSpeed,
+                      const float &a_maxTurnRate); // after the boids were replaced from a checkpoint
+
+    void reorderBoids();
+    void step(const float &a_dt);
+    void advance(const unsigned int &a_steps, const float &a_dt);
+    unsigned int chooseSubsteps(const float &a_duration) const;
+    unsigned int advanceFrame(const float &a_duration, const unsigned int &a_substeps);
+
+// private functions
+private:
+    void calculateObstacleForce(Boid &a_b, const float &a_dt);
+    void buildForceTables();
+
+// private variables
+private:
+    ProgramParameters m_params;
+    BoidStore m_boids;
+
+    SpatialGrid m_grid;
+    NeighbourList m_neighbours; // only used by the verlet search
+    NeighbourList m_nearNeighbours; // same within avoidance range, for the substeps without far forces
+    ThreadPool m_pool;
+    vector<Vec3Column> m_threadForces; // pair force accumulator per worker
+    vector<vector<unsigned int>> m_threadNeighbours; // candidate list per worker
+
+    PairKernelType m_pairKernelType;
+    pair_kernel_t m_pairKernel;
+    vector<float> m_curve; // memoized force function buckets
+    ForceTable m_farTable; // every band, far forces scaled for the multiple time stepping
+    ForceTable m_nearTable; // avoidance only, for the substeps in between
+    bool m_tablesStale; // curve or parameters changed since the tables were built
+    ForceCurveExchange *m_curveSource; // read at each substep when set
+    unsigned long m_curveVersion; // last version taken from it
+
+    vector<CylinderObstacle> m_obstacles;
+    bool m_obstacleMode;
+
+    vector<float> m_threadMaxSpeed; // squared, largest seen by each worker in the frame
+    vector<float> m_threadMaxTurn; // squared velocity change per substep, same
+    float m_maxSpeed; // of the last frame, negative until one has been measured
+    float m_maxTurnRate;
+
+    vector<unsigned long long> m_mortonKeys; // scratch for reorderBoids
+    vector<unsigned int> m_order;
+
+    Profiler *m_profiler;
+    unsigned int m_phaseNeighbours; // profiler phases of step()
+    unsigned int m_phaseBoundary;
+    unsigned int m_phasePairs;
+    unsigned int m_phaseIntegrate;
+
+    unsigned long m_steps; // substeps taken so far
+    unsigned long m_reorders;
+
+}; // class Simulation
+
+#endif // SIMULATION_H
@@ -0,0 +1,279 @@
+/**
+ * Filename: simulationthread.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include "simulationthread.h"
+#include "tracer.h"
+
+using namespace std;
+
+
+// class: SimulationThread
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+SimulationThread::SimulationThread(Simulation &a_sim,
+                                   const unsigned int &a_substeps,
+                                   const float &a_dt) : m_sim(a_sim),
+                                                        m_substeps(a_substeps),
+                                                        m_dt(a_dt),
+                                                        m_running(false),
+                                                        m_paused(false),
+                                                        m_obstacleChanged(false),
+                                                        m_obstacleMode(false),
+                                                        m_paramsChanged(false),
+                                                        m_previous(-1),
+                                                        m_latest(-1),
+                                                        m_readPrevious(-1),
+                                                        m_readLatest(-1),
+                                                        m_ticks(0),
+                                                        m_substepsTaken(0),
+                                                        m_lastSubsteps(a_substeps),
+                                                        m_tickRate(0.0) {
+    this->m_period = chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<double>(double(a_substeps) * a_dt));
+
+    // the simulation times its own phases inside each tick
+    this->m_phaseTick = this->m_profiler.addPhase("tick");
+    this->m_sim.setProfiler(&this->m_profiler);
+    this->m_phasePublish = this->m_profiler.addPhase("publish");
+    this->m_sim.setForceCurveSource(&this->m_curves);
+}
+
+SimulationThread::~SimulationThread() {
+    this->stop();
+    this->m_sim.setProfiler(nullptr);
+    this->m_sim.setForceCurveSource(nullptr);
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool SimulationThread::isRunning() const { return this->m_running.load(); }
+bool SimulationThread::isPaused() const { return this->m_paused.load(); }
+
+void SimulationThread::setPaused(const bool &a_paused) {
+    {
+        lock_guard<mutex> lock(this->m_wakeMutex);
+        this->m_paused.store(a_paused);
+    }
+    this->m_wake.notify_one();
+}
+
+double SimulationThread::getTickPeriod() const { return chrono::duration<double>(this->m_period).count(); }
+double SimulationThread::getTickRate() const { return this->m_tickRate.load(); }
+unsigned long SimulationThread::getTickCount() const { return this->m_ticks.load(); }
+unsigned int SimulationThread::getSubsteps() const { return this->m_substeps; }
+unsigned int SimulationThread::getLastSubsteps() const { return this->m_lastSubsteps.load(); }
+
+double SimulationThread::getAverageSubsteps() const {
+    unsigned long ticks = this->m_ticks.load();
+    return ticks == 0 ? this->m_substeps : static_cast<double>(this->m_substepsTaken.load()) / ticks;
+}
+Profiler &SimulationThread::getProfiler() { return this->m_profiler; }
+
+unsigned long SimulationThread::getForceCurveVersion() const { return this->m_curves.getVersion(); }
+
+void SimulationThread::setForceCurve(const float *a_values, const int &a_buckets) {
+    this->m_curves.publish(a_values, a_buckets);
+}
+
+void SimulationThread::setObstacleMode(const bool &a_mode) {
+    lock_guard<mutex> lock(this->m_changeMutex);
+    this->m_obstacleMode = a_mode;
+    this->m_obstacleChanged = true;
+}
+
+void SimulationThread::setParameters(const ProgramParameters &a_params) {
+    lock_guard<mutex> lock(this->m_changeMutex);
+    this->m_params = a_params;
+    this->m_paramsChanged = true;
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To publish the current state and start ticking. Nothing is interpolated
+ * from before the start, the simulation may have been changed while
+ * stopped (restored from a checkpoint, say).
+ */
+void SimulationThread::start() {
+    if (this->m_running) return;
+
+    this->applyChanges();
+    {
+        lock_guard<mutex> lock(this->m_snapshotMutex);
+        this->m_latest = -1;
+    }
+    this->publish();
+    this->m_running = true;
+    this->m_thread = thread(&SimulationThread::run, this);
+}
+
+/**
+ * To stop ticking and wait for the tick in progress to finish.
+ */
+void SimulationThread::stop() {
+    {
+        lock_guard<mutex> lock(this->m_wakeMutex);
+        this->m_running = false;
+    }
+    this->m_wake.notify_one();
+    if (this->m_thread.joinable())
+        this->m_thread.join();
+}
+
+/**
+ * To get the two latest snapshots (the same one twice until a second is
+ * published) and how far to interpolate between them at this moment. They
+ * stay untouched until release() is called. Returns false if nothing has
+ * been published yet.
+ */
+bool SimulationThread::acquire(const SimulationSnapshot *&a_previous,
+                               const SimulationSnapshot *&a_latest,
+                               float &a_alpha) {
+    lock_guard<mutex> lock(this->m_snapshotMutex);
+    if (this->m_latest < 0) return false;
+
+    this->m_readLatest = this->m_latest;
+    this->m_readPrevious = this->m_previous < 0 ? this->m_latest : this->m_previous;
+    a_previous = &this->m_snapshots[this->m_readPrevious];
+    a_latest = &this->m_snapshots[this->m_readLatest];
+
+    // show the previous tick as the latest is published and have caught
+    // up to the latest by the time the next one is due
+    double since = chrono::duration<double>(chrono::steady_clock::now() - a_latest->published).count();
+    a_alpha = static_cast<float>(std::min(std::max(since / this->getTickPeriod(), 0.0), 1.0));
+    return true;
+}
+
+/**
+ * To hand the snapshots from acquire() back.
+ */
+void SimulationThread::release() {
+    lock_guard<mutex> lock(this->m_snapshotMutex);
+    this->m_readPrevious = -1;
+    this->m_readLatest = -1;
+}
+
+/**
+ * To tick at a fixed rate until stopped. Ticks that come due while one is
+ * still running are run back to back to catch up, unless it has fallen too
+ * far behind, in which case the simulation slows down instead.
+ */
+void SimulationThread::run() {
+    Tracer::setThreadName("simulation");
+
+    auto next = chrono::steady_clock::now();
+    auto rateStart = next;
+    unsigned long rateTicks = 0;
+
+    while (this->m_running) {
+        if (this->m_paused) {
+            unique_lock<mutex> lock(this->m_wakeMutex);
+            this->m_wake.wait(lock, [this]() { return !this->m_running || !this->m_paused; });
+            next = chrono::steady_clock::now();
+            rateStart = next; // the pause doesn't count against the rate
+            rateTicks = 0;
+            continue;
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (now < next) {
+            unique_lock<mutex> lock(this->m_wakeMutex);
+            this->m_wake.wait_until(lock, next, [this]() { return !this->m_running || this->m_paused; });
+            continue;
+        }
+        if (now - next > this->m_period * MAX_CATCHUP_TICKS)
+            next = now;
+        next += this->m_period;
+
+        this->applyChanges();
+
+        this->m_profiler.beginFrame();
+        unsigned int substeps;
+        {
+            ProfileScope scope(&this->m_profiler, this->m_phaseTick);
+            TraceZone zone("tick");
+            substeps = this->m_sim.advanceFrame(this->m_substeps * this->m_dt, this->m_substeps);
+        }
+        {
+            ProfileScope scope(&this->m_profiler, this->m_phasePublish);
+            this->publish();
+        }
+        this->m_profiler.endFrame();
+
+        this->m_lastSubsteps = substeps;
+        this->m_substepsTaken += substeps;
+        this->m_ticks++;
+        rateTicks++;
+        double elapsed = chrono::duration<double>(now - rateStart).count();
+        if (elapsed >= 1.0) {
+            this->m_tickRate = rateTicks / elapsed;
+            rateStart = now;
+            rateTicks = 0;
+        }
+    }
+}
+
+/**
+ * To pass on whatever was handed over since the last tick.
+ */
+void SimulationThread::applyChanges() {
+    lock_guard<mutex> lock(this->m_changeMutex);
+    if (this->m_paramsChanged) {
+        this->m_sim.setParameters(this->m_params);
+        this->m_sim.resizeFlock(this->m_params.numBoids, static_cast<unsigned int>(this->m_sim.getStepCount()));
+        this->m_paramsChanged = false;
+    }
+    if (this->m_obstacleChanged) {
+        this->m_sim.setObstacleMode(this->m_obstacleMode);
+        this->m_obstacleChanged = false;
+    }
+}
+
+/**
+ * To copy the boid state into a snapshot nobody is using and make it the
+ * latest.
+ */
+void SimulationThread::publish() {
+    TraceZone zone("publish");
+
+    int slot = 0;
+    {
+        lock_guard<mutex> lock(this->m_snapshotMutex);
+        while (slot == this->m_previous || slot == this->m_latest ||
+               slot == this->m_readPrevious || slot == this->m_readLatest)
+            slot++;
+    }
+
+    SimulationSnapshot &snapshot = this->m_snapshots[slot];
+    const BoidStore &boids = this->m_sim.getBoids();
+    unsigned int n = boids.size();
+    snapshot.ids.resize(n);
+    snapshot.positions.resize(n);
+    snapshot.velocities.resize(n);
+    snapshot.lastForces.resize(n);
+
+    unsigned int k = 0;
+    for (unsigned int id = 0; id < boids.getIDLimit() && k < n; id++) {
+        unsigned int s = boids.slotOf(id);
+        if (s == NO_SLOT) continue;
+
+        snapshot.ids[k] = id;
+        snapshot.positions.set(k, boids.positions().get(s));
+        snapshot.velocities.set(k, boids.velocities().get(s));
+        snapshot.lastForces.set(k, boids.lastForces().get(s));
+        k++;
+    }
+    snapshot.step = this->m_sim.getStepCount();
+    snapshot.tick = this->m_ticks.load() + 1; // counted once published
+    snapshot.published = chrono::steady_clock::now();
+
+    lock_guard<mutex> lock(this->m_snapshotMutex);
+    this->m_previous = this->m_latest;
+    this->m_latest = slot;
+}
@@ -0,0 +1,187 @@
+/**
+ * Filename: simulationthread.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "forcecurve.h"
+#include "profiler.h"
+#include "simulation.h"
+
+using namespace std;
+
+
+// snapshots kept by the simulation thread, enough that publishing always
+// finds a free one while the reader holds on to the two it was given
+constexpr unsigned int SNAPSHOT_COUNT = 5;
+
+// ticks the simulation may fall behind before it gives up catching up
+constexpr unsigned int MAX_CATCHUP_TICKS = 4;
+
+
+/**
+ * Copy of the boid state after a tick, in ID order so two snapshots can be
+ * matched up boid by boid however the store was reordered in between.
+ */
+struct SimulationSnapshot {
+    vector<signed int> ids; // ascending
+    Vec3Column positions;
+    Vec3Column velocities;
+    Vec3Column lastForces;
+
+    unsigned long step; // substeps the simulation had taken
+    unsigned long tick; // ticks the thread had run, each a tick period of simulated time
+    chrono::steady_clock::time_point published;
+};
+
+
+/**
+ * Runs a Simulation on its own thread at a fixed rate: every tick advances
+ * it a_substeps substeps of a_dt seconds (or the same time in however many
+ * substeps it picks with adaptive substeps on) and the ticks are spaced so
+ * simulated time keeps up with wall time, whatever the frame rate.
+ *
+ * After each tick the state is published as a snapshot. A reader acquires
+ * the two latest and interpolates between them (interpolateSnapshots), so
+ * it shows the flock one tick behind but moving smoothly. Changes to the
+ * simulation (obstacle mode, parameters) are handed over and picked up
+ * before the next tick; force curve edits are published to it through a
+ * ForceCurveExchange and picked up at the next substep. The Simulation
+ * itself must not be used by anyone else while the thread runs.
+ */
+class SimulationThread {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    SimulationThread(Simulation &a_sim,
+                     const unsigned int &a_substeps = INTEGRATION,
+                     const float &a_dt = DELTA_T);
+    ~SimulationThread(); // stops the thread
+
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isRunning() const;
+    bool isPaused() const;
+    void setPaused(const bool &a_paused);
+
+    double getTickPeriod() const; // seconds of wall (and simulated) time per tick
+    double getTickRate() const; // ticks per second over the last second
+    unsigned long getTickCount() const;
+    unsigned int getSubsteps() const; // of every tick without adaptive substeps
+    unsigned int getLastSubsteps() const; // taken by the last tick
+    double getAverageSubsteps() const; // per tick since starting
+    Profiler &getProfiler(); // times the phases of each tick
+
+    unsigned long getForceCurveVersion() const; // latest published
+
+    // published for the next substep, never waits on the simulation; from one thread only
+    void setForceCurve(const float *a_values, const int &a_buckets);
+
+    // handed over to the simulation before its next tick, a new boid count
+    // grows or shrinks the flock there
+    void setObstacleMode(const bool &a_mode);
+    void setParameters(const ProgramParameters &a_params);
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    void start();
+    void stop();
+
+    bool acquire(const SimulationSnapshot *&a_previous,
+                 const SimulationSnapshot *&a_latest,
+                 float &a_alpha);
+    void release();
+
+// private functions
+private:
+    void run();
+    void applyChanges();
+    void publish();
+
+// private variables
+private:
+    Simulation &m_sim;
+    unsigned int m_substeps;
+    float m_dt;
+    chrono::steady_clock::duration m_period;
+
+    thread m_thread;
+    atomic<bool> m_running;
+    atomic<bool> m_paused;
+    mutex m_wakeMutex; // wakes the thread early to stop or pause
+    condition_variable m_wake;
+
+    // handoff from the other threads
+    ForceCurveExchange m_curves;
+    mutex m_changeMutex;
+    bool m_obstacleChanged;
+    bool m_obstacleMode;
+    bool m_paramsChanged;
+    ProgramParameters m_params;
+
+    // snapshots, the indices are guarded by m_snapshotMutex
+    SimulationSnapshot m_snapshots[SNAPSHOT_COUNT];
+    mutex m_snapshotMutex;
+    int m_previous; // -1 until published
+    int m_latest;
+    int m_readPrevious; // held by the reader, -1 if none
+    int m_readLatest;
+
+    Profiler m_profiler;
+    unsigned int m_phaseTick;
+    unsigned int m_phasePublish;
+
+    atomic<unsigned long> m_ticks;
+    atomic<unsigned long> m_substepsTaken; // over every tick
+    atomic<unsigned int> m_lastSubsteps;
+    atomic<double> m_tickRate;
+
+}; // class SimulationThread
+
+
+/**
+ * To call a_visit(position, velocity, lastForce) for every boid in a_latest
+ * with its state a_alpha of the way from a_previous. Boids missing from
+ * a_previous are shown as they are in a_latest.
+ */
+template <typename Visit>
+void interpolateSnapshots(const SimulationSnapshot &a_previous,
+                          const SimulationSnapshot &a_latest,
+                          const float &a_alpha,
+                          Visit &&a_visit) {
+    auto mix = [&](const Vec3Column &a_from, unsigned int a_i, const Vec3Column &a_to, unsigned int a_j) {
+        return vec3f(a_from.x[a_i] + (a_to.x[a_j] - a_from.x[a_i]) * a_alpha,
+                     a_from.y[a_i] + (a_to.y[a_j] - a_from.y[a_i]) * a_alpha,
+                     a_from.z[a_i] + (a_to.z[a_j] - a_from.z[a_i]) * a_alpha);
+    };
+
+    // both are in ID order, walk them side by side
+    unsigned int i = 0;
+    for (unsigned int j = 0; j < a_latest.ids.size(); j++) {
+        while (i < a_previous.ids.size() && a_previous.ids[i] < a_latest.ids[j])
+            i++;
+
+        if (i < a_previous.ids.size() && a_previous.ids[i] == a_latest.ids[j])
+            a_visit(mix(a_previous.positions, i, a_latest.positions, j),
+                    mix(a_previous.velocities, i, a_latest.velocities, j),
+                    mix(a_previous.lastForces, i, a_latest.lastForces, j));
+        else
+            a_visit(a_latest.positions.get(j), a_latest.velocities.get(j), a_latest.lastForces.get(j));
+    }
+}
+
+#endif // SIMULATIONTHREAD_H
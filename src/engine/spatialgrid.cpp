@@ -0,0 +1,91 @@
+/**
+ * Filename: spatialgrid.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "spatialgrid.h"
+
+using namespace std;
+using namespace givr;
+
+
+// largest number of cells along one axis, cells grow past the search range
+// instead of going over this to keep the cell table small
+constexpr int MAX_GRID_DIM = 128;
+
+
+// class: SpatialGrid
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+SpatialGrid::SpatialGrid() : m_cellSize(1.0f),
+                             m_extent(1.0f),
+                             m_dim(1) {}
+
+SpatialGrid::~SpatialGrid() {}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+float SpatialGrid::getCellSize() const { return this->m_cellSize; }
+
+unsigned int SpatialGrid::getCellCount() const { return this->m_dim * this->m_dim * this->m_dim; }
+
+size_t SpatialGrid::getMemoryUsage() const {
+    return (this->m_cellStart.capacity() + this->m_cellOf.capacity() + this->m_sorted.capacity()) * sizeof(unsigned int);
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To bin every boid into its cell. Uses a counting sort so the boids of a
+ * cell end up next to each other in m_sorted.
+ */
+void SpatialGrid::rebuild(const BoidStore &a_boids,
+                          const float &a_cellSize,
+                          const float &a_extent) {
+
+    this->m_extent = a_extent;
+    this->m_dim = std::max(1, static_cast<int>(std::floor((2.0f * a_extent) / a_cellSize)));
+    this->m_dim = std::min(this->m_dim, MAX_GRID_DIM);
+    this->m_cellSize = (2.0f * a_extent) / this->m_dim; // never smaller than a_cellSize
+
+    unsigned int cells = this->getCellCount();
+    this->m_cellStart.assign(cells + 1, 0);
+    this->m_cellOf.resize(a_boids.size());
+    this->m_sorted.resize(a_boids.size());
+
+    // count boids per cell
+    const Vec3Column &p = a_boids.positions();
+    for (unsigned int i = 0; i < a_boids.size(); i++) {
+        unsigned int cell = this->cellIndex(this->cellCoord(p.x[i]),
+                                            this->cellCoord(p.y[i]),
+                                            this->cellCoord(p.z[i]));
+        this->m_cellOf[i] = cell;
+        this->m_cellStart[cell + 1]++;
+    }
+
+    // prefix sum into cell offsets
+    for (unsigned int c = 0; c < cells; c++)
+        this->m_cellStart[c + 1] += this->m_cellStart[c];
+
+    // scatter boids into their cells
+    vector<unsigned int> fill(this->m_cellStart.begin(), this->m_cellStart.end() - 1);
+    for (unsigned int i = 0; i < a_boids.size(); i++)
+        this->m_sorted[fill[this->m_cellOf[i]]++] = i;
+}
+
+/**
+ * To get the cell along one axis, clamped to the grid.
+ */
+int SpatialGrid::cellCoord(const float &a_x) const {
+    int c = static_cast<int>(std::floor((a_x + this->m_extent) / this->m_cellSize));
+    return std::min(std::max(c, 0), this->m_dim - 1);
+}
+
+unsigned int SpatialGrid::cellIndex(const int &a_x, const int &a_y, const int &a_z) const {
+    return (a_z * this->m_dim + a_y) * this->m_dim + a_x;
+}
@@ -0,0 +1,92 @@
+/**
+ * Filename: spatialgrid.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+
+#include <vector>
+#include "givr.h"
+#include "boidstore.h"
+
+using namespace std;
+using namespace givr;
+
+
+/**
+ * Uniform grid used to find the boids that are within search range of each
+ * other without testing every pair. Cells are at least as wide as the max
+ * search range so all neighbours of a boid lie in the 27 cells around it.
+ *
+ * The grid covers the cube [-extent, extent]^3; boids outside of it are
+ * clamped into the border cells, which keeps the 27 cell query exact.
+ */
+class SpatialGrid {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    SpatialGrid();
+    ~SpatialGrid();
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    void rebuild(const BoidStore &a_boids,
+                 const float &a_cellSize,
+                 const float &a_extent);
+
+    template <typename Visitor>
+    void forEachNeighbour(const vec3f &a_p, Visitor &&a_visit) const;
+
+    float getCellSize() const;
+    unsigned int getCellCount() const;
+    size_t getMemoryUsage() const;
+
+// private functions
+private:
+    int cellCoord(const float &a_x) const;
+    unsigned int cellIndex(const int &a_x, const int &a_y, const int &a_z) const;
+
+// private variables
+private:
+    float m_cellSize;
+    float m_extent;
+    int m_dim; // cells along each axis
+
+    vector<unsigned int> m_cellStart; // offset of each cell into m_sorted (size cells + 1)
+    vector<unsigned int> m_cellOf; // cell of each slot from the last rebuild
+    vector<unsigned int> m_sorted; // store slots ordered by cell
+
+}; // class SpatialGrid
+
+
+
+/**
+ * Call a_visit(unsigned int slot) for every boid in the 27 cells around a_p.
+ * The caller still has to do the distance test.
+ */
+template <typename Visitor>
+void SpatialGrid::forEachNeighbour(const vec3f &a_p, Visitor &&a_visit) const {
+    int cx = this->cellCoord(a_p.x);
+    int cy = this->cellCoord(a_p.y);
+    int cz = this->cellCoord(a_p.z);
+
+    for (int z = cz - 1; z <= cz + 1; z++) {
+        if (z < 0 || z >= this->m_dim) continue;
+        for (int y = cy - 1; y <= cy + 1; y++) {
+            if (y < 0 || y >= this->m_dim) continue;
+            for (int x = cx - 1; x <= cx + 1; x++) {
+                if (x < 0 || x >= this->m_dim) continue;
+
+                unsigned int cell = this->cellIndex(x, y, z);
+                for (unsigned int i = this->m_cellStart[cell]; i < this->m_cellStart[cell + 1]; i++)
+                    a_visit(this->m_sorted[i]);
+            }
+        }
+    }
+}
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,136 @@
+/**
+ * Filename: threadpool.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <string>
+#include "threadpool.h"
+#include "tracer.h"
+
+using namespace std;
+
+
+// class: ThreadPool
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+ThreadPool::ThreadPool(unsigned int a_threads) : m_task(nullptr),
+                                                 m_name(nullptr),
+                                                 m_count(0),
+                                                 m_chunk(1),
+                                                 m_next(0),
+                                                 m_active(0),
+                                                 m_generation(0),
+                                                 m_stop(false) {
+    if (a_threads == 0)
+        a_threads = std::max(1u, thread::hardware_concurrency());
+
+    // the calling thread is worker 0
+    for (unsigned int i = 1; i < a_threads; i++)
+        this->m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(this->m_mutex);
+        this->m_stop = true;
+    }
+    this->m_start.notify_all();
+
+    for (thread &t : this->m_threads)
+        t.join();
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+unsigned int ThreadPool::getThreadCount() const { return this->m_threads.size() + 1; }
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+
+/**
+ * To run a_task over [0, a_count) in chunks of a_chunk across every worker.
+ * Returns once the whole range has been processed.
+ */
+void ThreadPool::parallelFor(const unsigned int &a_count,
+                             const unsigned int &a_chunk,
+                             const task_t &a_task,
+                             const char *a_name) {
+    if (a_count == 0) return;
+
+    // not worth waking anyone up
+    if (this->m_threads.empty() || a_count <= a_chunk) {
+        TraceZone zone(a_name);
+        a_task(0, a_count, 0);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(this->m_mutex);
+        this->m_task = &a_task;
+        this->m_name = a_name;
+        this->m_count = a_count;
+        this->m_chunk = std::max(1u, a_chunk);
+        this->m_next.store(0);
+        this->m_active = this->m_threads.size();
+        this->m_generation++;
+    }
+    this->m_start.notify_all();
+
+    this->runChunks(0);
+
+    // wait for the other workers to drain the range
+    unique_lock<mutex> lock(this->m_mutex);
+    this->m_done.wait(lock, [this]() { return this->m_active == 0; });
+    this->m_task = nullptr;
+}
+
+/**
+ * To grab chunks of the current loop until there are none left. When
+ * tracing, the share of this worker is recorded as one zone along with
+ * how many items it got through.
+ */
+void ThreadPool::runChunks(unsigned int a_worker) {
+    bool tracing = Tracer::isEnabled();
+    unsigned long long start = tracing ? Tracer::now() : 0;
+    unsigned int items = 0;
+
+    while (true) {
+        unsigned int begin = this->m_next.fetch_add(this->m_chunk);
+        if (begin >= this->m_count) break;
+
+        unsigned int end = std::min(begin + this->m_chunk, this->m_count);
+        (*this->m_task)(begin, end, a_worker);
+        items += end - begin;
+    }
+
+    if (tracing && items > 0)
+        Tracer::record(this->m_name, start, Tracer::now(), items);
+}
+
+/**
+ * Body of each worker thread, sleeps until a loop is posted.
+ */
+void ThreadPool::workerLoop(unsigned int a_worker) {
+    unsigned long seen = 0;
+    Tracer::setThreadName("worker " + to_string(a_worker));
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(this->m_mutex);
+            this->m_start.wait(lock, [&]() { return this->m_stop || this->m_generation != seen; });
+            if (this->m_stop) return;
+            seen = this->m_generation;
+        }
+
+        this->runChunks(a_worker);
+
+        {
+            lock_guard<mutex> lock(this->m_mutex);
+            if (--this->m_active == 0)
+                this->m_done.notify_one();
+        }
+    }
+}
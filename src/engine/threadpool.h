@@ -0,0 +1,80 @@
+/**
+ * Filename: threadpool.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * Fixed set of worker threads used to split a loop over the boids. The
+ * calling thread takes part as worker 0, so a pool of one thread runs
+ * everything inline.
+ *
+ * Work is handed out in chunks from a shared counter so threads that get
+ * cheap boids (few neighbours) pick up more of them.
+ */
+class ThreadPool {
+// public types
+public:
+    // called with [begin, end) of the range and the index of the worker
+    using task_t = function<void(unsigned int, unsigned int, unsigned int)>;
+
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    ThreadPool(unsigned int a_threads = 0); // 0 uses every hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    unsigned int getThreadCount() const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    void parallelFor(const unsigned int &a_count,
+                     const unsigned int &a_chunk,
+                     const task_t &a_task,
+                     const char *a_name = "work"); // zone name of each worker's share in a trace
+
+// private functions
+private:
+    void workerLoop(unsigned int a_worker);
+    void runChunks(unsigned int a_worker);
+
+// private variables
+private:
+    vector<thread> m_threads;
+
+    mutex m_mutex;
+    condition_variable m_start; // signalled when a new loop is posted
+    condition_variable m_done; // signalled when the last worker finishes
+
+    const task_t *m_task; // loop currently being run
+    const char *m_name;
+    unsigned int m_count;
+    unsigned int m_chunk;
+    atomic<unsigned int> m_next; // start of the next chunk to hand out
+    unsigned int m_active; // workers still inside the current loop
+    unsigned long m_generation; // bumped for every posted loop
+    bool m_stop;
+
+}; // class ThreadPool
+
+#endif // THREADPOOL_H
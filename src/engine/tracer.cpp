@@ -0,0 +1,186 @@
+/**
+ * Filename: tracer.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "tracer.h"
+
+using namespace std;
+
+
+// one finished zone
+struct TraceEvent {
+    const char *name;
+    unsigned long long start; // ns
+    unsigned long long duration; // ns
+    unsigned int items;
+};
+
+// zones of one thread, only that thread writes to it
+struct TraceBuffer {
+    unsigned int tid;
+    string name;
+    atomic<unsigned long> generation; // trace the events belong to
+    vector<TraceEvent> events;
+    atomic<unsigned int> count; // events published so far
+    atomic<unsigned long> dropped;
+};
+
+
+atomic<bool> Tracer::s_enabled(false);
+
+// every buffer ever registered, buffers outlive their thread so a trace
+// still holds the zones of workers that have since exited
+static mutex s_registryMutex;
+static vector<unique_ptr<TraceBuffer>> s_buffers;
+static atomic<unsigned long> s_generation(0);
+
+static thread_local TraceBuffer *t_buffer = nullptr;
+static thread_local string t_name;
+
+
+/**
+ * To get the buffer of the calling thread, registering it on first use.
+ * A buffer left over from an older trace is emptied by its own thread
+ * here so readers never see a reset while it is being written.
+ */
+static TraceBuffer *threadBuffer() {
+    if (t_buffer == nullptr) {
+        unique_ptr<TraceBuffer> buffer(new TraceBuffer());
+        buffer->events.resize(TRACE_BUFFER_EVENTS);
+        buffer->count.store(0);
+        buffer->dropped.store(0);
+
+        lock_guard<mutex> lock(s_registryMutex);
+        buffer->tid = s_buffers.size() + 1;
+        buffer->name = t_name.empty() ? "thread " + to_string(buffer->tid) : t_name;
+        buffer->generation.store(s_generation.load());
+        t_buffer = buffer.get();
+        s_buffers.push_back(std::move(buffer));
+    }
+
+    unsigned long generation = s_generation.load(memory_order_acquire);
+    if (t_buffer->generation.load(memory_order_relaxed) != generation) {
+        t_buffer->count.store(0, memory_order_relaxed);
+        t_buffer->dropped.store(0, memory_order_relaxed);
+        t_buffer->generation.store(generation, memory_order_release);
+    }
+    return t_buffer;
+}
+
+
+// class: Tracer
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+void Tracer::setEnabled(const bool &a_enabled) {
+    if (a_enabled && !isEnabled())
+        clear();
+    s_enabled.store(a_enabled);
+}
+
+void Tracer::setThreadName(const string &a_name) {
+    t_name = a_name;
+    if (t_buffer != nullptr) {
+        lock_guard<mutex> lock(s_registryMutex);
+        t_buffer->name = a_name;
+    }
+}
+
+unsigned long Tracer::getEventCount() {
+    lock_guard<mutex> lock(s_registryMutex);
+    unsigned long generation = s_generation.load(), events = 0;
+    for (const unique_ptr<TraceBuffer> &buffer : s_buffers)
+        if (buffer->generation.load(memory_order_acquire) == generation)
+            events += buffer->count.load(memory_order_acquire);
+    return events;
+}
+
+unsigned long Tracer::getDroppedCount() {
+    lock_guard<mutex> lock(s_registryMutex);
+    unsigned long generation = s_generation.load(), dropped = 0;
+    for (const unique_ptr<TraceBuffer> &buffer : s_buffers)
+        if (buffer->generation.load(memory_order_acquire) == generation)
+            dropped += buffer->dropped.load(memory_order_relaxed);
+    return dropped;
+}
+
+
+////////////////////////////////// FUNCTIONS /////////////////////////////////////
+unsigned long long Tracer::now() {
+    static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+/**
+ * To add a finished zone to the buffer of the calling thread.
+ */
+void Tracer::record(const char *a_name,
+                    const unsigned long long &a_start,
+                    const unsigned long long &a_end,
+                    const unsigned int &a_items) {
+    TraceBuffer *buffer = threadBuffer();
+    unsigned int index = buffer->count.load(memory_order_relaxed);
+    if (index >= buffer->events.size()) {
+        buffer->dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    buffer->events[index] = {a_name, a_start, a_end - a_start, a_items};
+    buffer->count.store(index + 1, memory_order_release); // publish it to the writer
+}
+
+/**
+ * To start a new, empty trace. Each thread drops its old zones the next
+ * time it records one.
+ */
+void Tracer::clear() {
+    s_generation.fetch_add(1, memory_order_acq_rel);
+}
+
+/**
+ * To write every zone of the current trace as trace event json. Threads
+ * may keep recording while this runs, zones published after a buffer was
+ * read are left out.
+ */
+bool Tracer::write(const string &a_filename) {
+    ofstream oFile(a_filename);
+    if (!oFile.is_open()) return false;
+
+    lock_guard<mutex> lock(s_registryMutex);
+    unsigned long generation = s_generation.load();
+    bool first = true;
+    auto separator = [&]() -> ofstream & {
+        oFile << (first ? "\n" : ",\n");
+        first = false;
+        return oFile;
+    };
+
+    oFile << fixed << setprecision(3); // microseconds down to the nanosecond
+    oFile << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (const unique_ptr<TraceBuffer> &buffer : s_buffers) {
+        if (buffer->generation.load(memory_order_acquire) != generation) continue;
+
+        separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+                    << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+
+        unsigned int count = buffer->count.load(memory_order_acquire);
+        for (unsigned int i = 0; i < count; i++) {
+            const TraceEvent &e = buffer->events[i];
+            separator() << "{\"name\": \"" << e.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid
+                        << ", \"ts\": " << e.start / 1000.0 << ", \"dur\": " << e.duration / 1000.0;
+            if (e.items != 0)
+                oFile << ", \"args\": {\"items\": " << e.items << "}";
+            oFile << "}";
+        }
+    }
+    oFile << "\n]}\n";
+    return oFile.good();
+}
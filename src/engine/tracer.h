@@ -0,0 +1,86 @@
+/**
+ * Filename: tracer.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+
+// zones each thread can hold until the trace is written or cleared
+constexpr unsigned int TRACE_BUFFER_EVENTS = 1 << 18;
+
+
+/**
+ * Records timed zones from any thread and writes them as chrome trace
+ * event json (chrome://tracing, ui.perfetto.dev). Every thread appends to
+ * its own fixed size buffer, so recording never takes a lock; only the
+ * first zone of a new thread registers its buffer. Zones past the end of
+ * a full buffer are dropped and counted.
+ *
+ * Zone names are not copied and have to outlive the trace (string
+ * literals). While disabled a TraceZone costs one atomic load.
+ */
+class Tracer {
+// public functions
+public:
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    static bool isEnabled() { return s_enabled.load(memory_order_relaxed); }
+    static void setEnabled(const bool &a_enabled); // enabling starts a new trace
+
+    static void setThreadName(const string &a_name); // name of the calling thread in the trace
+    static unsigned long getEventCount(); // zones in the current trace
+    static unsigned long getDroppedCount(); // zones lost to full buffers
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    static unsigned long long now(); // nanoseconds since the first call
+    static void record(const char *a_name,
+                       const unsigned long long &a_start,
+                       const unsigned long long &a_end,
+                       const unsigned int &a_items = 0); // items shown as an argument if non zero
+
+    static void clear();
+    static bool write(const string &a_filename);
+
+// private variables
+private:
+    static atomic<bool> s_enabled;
+
+}; // class Tracer
+
+
+/**
+ * Records the time until it goes out of scope as a zone of the calling
+ * thread.
+ */
+class TraceZone {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    TraceZone(const char *a_name) : m_name(Tracer::isEnabled() ? a_name : nullptr),
+                                    m_start(m_name != nullptr ? Tracer::now() : 0) {}
+    ~TraceZone() {
+        if (this->m_name != nullptr)
+            Tracer::record(this->m_name, this->m_start, Tracer::now());
+    }
+
+    TraceZone(const TraceZone &) = delete;
+    TraceZone &operator=(const TraceZone &) = delete;
+
+// private variables
+private:
+    const char *m_name;
+    unsigned long long m_start;
+
+}; // class TraceZone
+
+#endif // TRACER_H
@@ -0,0 +1,751 @@
+/**
+ * Filename: trajectory.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "trajectory.h"
+#include "tracer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TRAJECTORY_MMAP 1
+#endif
+
+using namespace std;
+
+
+constexpr char TRAJECTORY_MAGIC[8] = {'B', 'O', 'I', 'D', 'T', 'R', 'A', 'J'};
+constexpr char TRAJECTORY_INDEX_MAGIC[8] = {'T', 'R', 'A', 'J', 'I', 'N', 'D', 'X'};
+constexpr size_t TRAJECTORY_HEADER_SIZE = 32;
+constexpr size_t TRAJECTORY_FOOTER_SIZE = 16;
+
+// quantized coordinates are clamped to this, leaving room for the predictions
+constexpr float QUANTIZED_LIMIT = float(1 << 30);
+
+// header fields, little-endian at these byte offsets
+constexpr size_t HEADER_VERSION = 8;
+constexpr size_t HEADER_QUANTUM = 12;
+constexpr size_t HEADER_ARENA_RADIUS = 16;
+constexpr size_t HEADER_BOID_MASS = 20;
+constexpr size_t HEADER_TICK_SECONDS = 24;
+
+// the first byte of every record
+enum TrajectoryRecord {
+    RECORD_KEYFRAME,
+    RECORD_DELTA,
+    RECORD_INDEX
+};
+
+
+/**
+ * To write a_v little-endian into a_out.
+ */
+template <typename T>
+static void putLittle(unsigned char *a_out, T a_v) {
+    uint64_t bits = 0;
+    memcpy(&bits, &a_v, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); i++)
+        a_out[i] = static_cast<unsigned char>(bits >> (8 * i));
+}
+
+/**
+ * To read a little-endian T from a_in.
+ */
+template <typename T>
+static T getLittle(const unsigned char *a_in) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); i++)
+        bits |= uint64_t(a_in[i]) << (8 * i);
+    T v;
+    memcpy(&v, &bits, sizeof(T));
+    return v;
+}
+
+/**
+ * To append a_v 7 bits a byte, low bits first, the top bit set on all but
+ * the last byte.
+ */
+static void putVarint(vector<unsigned char> &a_out, uint64_t a_v) {
+    while (a_v >= 0x80) {
+        a_out.push_back(static_cast<unsigned char>(a_v | 0x80));
+        a_v >>= 7;
+    }
+    a_out.push_back(static_cast<unsigned char>(a_v));
+}
+
+/**
+ * To read a varint at a_at, moving a_at past it. Returns false if it runs
+ * into a_end.
+ */
+static inline bool getVarint(const unsigned char *&a_at, const unsigned char *a_end, uint64_t &a_v) {
+    if (a_at < a_end && *a_at < 0x80) { // most residuals fit in a byte
+        a_v = *a_at++;
+        return true;
+    }
+    a_v = 0;
+    for (unsigned int shift = 0; a_at < a_end && shift < 64; shift += 7) {
+        unsigned char byte = *a_at++;
+        a_v |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// signed values interleaved so small ones of either sign stay small
+static inline uint64_t zigzag(int64_t a_v) { return (uint64_t(a_v) << 1) ^ uint64_t(a_v >> 63); }
+static inline int64_t unzigzag(uint64_t a_v) { return int64_t(a_v >> 1) ^ -int64_t(a_v & 1); }
+
+/**
+ * To predict a coordinate from the frames before it: where it was if it
+ * has only one, otherwise carried on at the velocity between the two
+ * scaled to the gaps in ticks between them. Encoder and decoder must agree
+ * on this to the bit, so it's all integer.
+ */
+static inline int64_t predict(const int64_t &a_q1, const int64_t &a_q2, const unsigned int &a_frames,
+                              const int64_t &a_gap1, const int64_t &a_gap2) {
+    if (a_frames < 2) return a_q1;
+    if (a_gap1 == a_gap2) return 2 * a_q1 - a_q2; // the same, without the division
+    return a_q1 + (a_q1 - a_q2) * a_gap1 / a_gap2;
+}
+
+
+// class: TrajectoryRecorder
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+TrajectoryRecorder::TrajectoryRecorder() : m_quantum(1.0f),
+                                           m_recording(false),
+                                           m_head(0),
+                                           m_tail(0),
+                                           m_dropped(false),
+                                           m_lastTick(0),
+                                           m_stopping(false),
+                                           m_ticks{0, 0, 0},
+                                           m_history(0),
+                                           m_offset(0),
+                                           m_frames(0),
+                                           m_droppedFrames(0),
+                                           m_bytesWritten(0),
+                                           m_boidFrames(0) {}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    this->stop();
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool TrajectoryRecorder::isRecording() const { return this->m_recording.load(); }
+const string &TrajectoryRecorder::getFilename() const { return this->m_filename; }
+unsigned long TrajectoryRecorder::getFrameCount() const { return this->m_frames.load(); }
+unsigned long TrajectoryRecorder::getDroppedCount() const { return this->m_droppedFrames.load(); }
+unsigned long long TrajectoryRecorder::getBytesWritten() const { return this->m_bytesWritten.load(); }
+
+double TrajectoryRecorder::getBytesPerBoidFrame() const {
+    unsigned long long boidFrames = this->m_boidFrames.load();
+    return boidFrames == 0 ? 0.0 : double(this->m_bytesWritten.load()) / boidFrames;
+}
+
+
+/////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+
+/**
+ * To start recording to a_filename, replacing it, stopping any recording
+ * already going. Positions are quantized to a_arenaRadius / 2^16; the mass
+ * is kept so the reader can give forces. Returns false if the file can't
+ * be created.
+ */
+bool TrajectoryRecorder::start(const string &a_filename,
+                               const float &a_arenaRadius,
+                               const float &a_boidMass,
+                               const double &a_tickSeconds) {
+    this->stop();
+
+    this->m_out.open(a_filename, ios::binary | ios::trunc);
+    if (!this->m_out) return false;
+
+    this->m_filename = a_filename;
+    this->m_quantum = a_arenaRadius / float(1u << TRAJECTORY_QUANTUM_BITS);
+    if (!(this->m_quantum > 0.0f)) this->m_quantum = 1.0f / float(1u << TRAJECTORY_QUANTUM_BITS);
+
+    unsigned char header[TRAJECTORY_HEADER_SIZE] = {};
+    memcpy(header, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC));
+    putLittle(header + HEADER_VERSION, TRAJECTORY_VERSION);
+    putLittle(header + HEADER_QUANTUM, this->m_quantum);
+    putLittle(header + HEADER_ARENA_RADIUS, a_arenaRadius);
+    putLittle(header + HEADER_BOID_MASS, a_boidMass);
+    putLittle(header + HEADER_TICK_SECONDS, a_tickSeconds);
+    this->m_out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    this->m_ids.clear();
+    this->m_history = 0;
+    this->m_lastTick = 0; // ticks are counted from 1
+    this->m_keyframes.clear();
+    this->m_tickGaps.clear();
+    this->m_offset = TRAJECTORY_HEADER_SIZE;
+    this->m_frames = 0;
+    this->m_droppedFrames = 0;
+    this->m_bytesWritten = TRAJECTORY_HEADER_SIZE;
+    this->m_boidFrames = 0;
+
+    this->m_head = 0;
+    this->m_tail = 0;
+    this->m_dropped = false;
+    this->m_stopping = false;
+    this->m_recording = true;
+    this->m_thread = thread(&TrajectoryRecorder::run, this);
+    return true;
+}
+
+/**
+ * To queue a copy of a_snapshot's IDs and positions for the writer. If the
+ * queue is full the frame is dropped. Snapshots no later than the last
+ * one recorded are skipped.
+ */
+void TrajectoryRecorder::record(const SimulationSnapshot &a_snapshot) {
+    if (!this->m_recording.load(memory_order_relaxed)) return;
+    if (a_snapshot.tick <= this->m_lastTick) return;
+    this->m_lastTick = a_snapshot.tick;
+
+    unsigned long tail = this->m_tail.load(memory_order_relaxed);
+    if (tail - this->m_head.load(memory_order_acquire) >= TRAJECTORY_QUEUE_FRAMES) {
+        this->m_dropped = true;
+        this->m_droppedFrames++;
+        return;
+    }
+
+    PendingFrame &frame = this->m_queue[tail % TRAJECTORY_QUEUE_FRAMES];
+    frame.tick = a_snapshot.tick;
+    frame.step = a_snapshot.step;
+    frame.ids = a_snapshot.ids;
+    frame.positions = a_snapshot.positions;
+    frame.keyframe = this->m_dropped;
+    this->m_dropped = false;
+    this->m_tail.store(tail + 1, memory_order_release);
+
+    {
+        lock_guard<mutex> lock(this->m_wakeMutex);
+    }
+    this->m_wake.notify_one();
+}
+
+/**
+ * To write the frames still queued, then the keyframe index, and close
+ * the file.
+ */
+bool TrajectoryRecorder::stop() {
+    if (!this->m_recording) return true;
+    this->m_recording = false;
+
+    {
+        lock_guard<mutex> lock(this->m_wakeMutex);
+        this->m_stopping = true;
+    }
+    this->m_wake.notify_one();
+    if (this->m_thread.joinable())
+        this->m_thread.join();
+
+    this->writeIndex();
+    this->m_out.close();
+    bool written = !this->m_out.fail();
+    this->m_out.clear();
+    return written;
+}
+
+/**
+ * To write out queued frames as they come until stopped.
+ */
+void TrajectoryRecorder::run() {
+    Tracer::setThreadName("trajectory");
+
+    unsigned long head = this->m_head.load(memory_order_relaxed);
+    while (true) {
+        {
+            unique_lock<mutex> lock(this->m_wakeMutex);
+            this->m_wake.wait(lock, [&]() {
+                return this->m_stopping || head != this->m_tail.load(memory_order_acquire);
+            });
+            if (this->m_stopping && head == this->m_tail.load(memory_order_acquire))
+                break;
+        }
+
+        while (head != this->m_tail.load(memory_order_acquire)) {
+            this->write(this->m_queue[head % TRAJECTORY_QUEUE_FRAMES]);
+            this->m_head.store(++head, memory_order_release);
+        }
+    }
+    this->m_out.flush();
+}
+
+/**
+ * To encode a_frame as a keyframe or the difference from the prediction
+ * and write it out.
+ */
+void TrajectoryRecorder::write(const PendingFrame &a_frame) {
+    TraceZone zone("trajectory write");
+    unsigned int n = a_frame.ids.size();
+
+    bool keyframe = a_frame.keyframe || this->m_history == 0 ||
+                    this->m_history >= TRAJECTORY_KEYFRAME_INTERVAL || a_frame.ids != this->m_ids;
+    unsigned int frames = keyframe ? 0 : this->m_history;
+
+    std::swap(this->m_q[2], this->m_q[1]);
+    std::swap(this->m_q[1], this->m_q[0]);
+    this->m_ticks[2] = this->m_ticks[1];
+    this->m_ticks[1] = this->m_ticks[0];
+    this->m_ticks[0] = a_frame.tick;
+
+    vector<int32_t> &q = this->m_q[0];
+    q.resize(3 * n);
+    float scale = 1.0f / this->m_quantum;
+    auto quantize = [scale](float a_x) {
+        return int32_t(std::lround(std::min(std::max(a_x * scale, -QUANTIZED_LIMIT), QUANTIZED_LIMIT)));
+    };
+    for (unsigned int i = 0; i < n; i++) {
+        q[3 * i + 0] = quantize(a_frame.positions.x[i]);
+        q[3 * i + 1] = quantize(a_frame.positions.y[i]);
+        q[3 * i + 2] = quantize(a_frame.positions.z[i]);
+    }
+
+    vector<unsigned char> &bytes = this->m_bytes;
+    bytes.clear();
+    if (keyframe) {
+        // IDs ascending, so as gaps; then the positions as they are
+        int previous = -1;
+        for (signed int id : a_frame.ids) {
+            putVarint(bytes, uint64_t(id - previous - 1));
+            previous = id;
+        }
+        for (int32_t v : q)
+            putVarint(bytes, zigzag(v));
+        this->m_ids = a_frame.ids;
+        this->m_keyframes.push_back({this->m_frames.load(), a_frame.tick, this->m_offset});
+        this->m_history = 1;
+    } else {
+        const vector<int32_t> &q1 = this->m_q[1], &q2 = this->m_q[2];
+        int64_t gap1 = int64_t(this->m_ticks[0] - this->m_ticks[1]);
+        int64_t gap2 = int64_t(this->m_ticks[1] - this->m_ticks[2]);
+        for (size_t i = 0; i < q.size(); i++)
+            putVarint(bytes, zigzag(q[i] - predict(q1[i], frames >= 2 ? q2[i] : 0, frames, gap1, gap2)));
+        this->m_history++;
+    }
+    putVarint(this->m_tickGaps, this->m_frames.load() == 0 ? a_frame.tick : a_frame.tick - this->m_ticks[1]);
+
+    vector<unsigned char> record;
+    record.push_back(keyframe ? RECORD_KEYFRAME : RECORD_DELTA);
+    putVarint(record, a_frame.tick);
+    putVarint(record, a_frame.step);
+    putVarint(record, n);
+    putVarint(record, bytes.size());
+    this->m_out.write(reinterpret_cast<const char *>(record.data()), record.size());
+    this->m_out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+    this->m_offset += record.size() + bytes.size();
+    this->m_bytesWritten = this->m_offset;
+    this->m_boidFrames += n;
+    this->m_frames++;
+}
+
+/**
+ * To write the index of the keyframes and the footer pointing at it.
+ */
+void TrajectoryRecorder::writeIndex() {
+    vector<unsigned char> &bytes = this->m_bytes;
+    bytes.clear();
+    putVarint(bytes, this->m_frames.load());
+    putVarint(bytes, this->m_keyframes.size());
+    for (const TrajectoryKeyframe &keyframe : this->m_keyframes) {
+        putVarint(bytes, keyframe.frame);
+        putVarint(bytes, keyframe.tick);
+        putVarint(bytes, keyframe.offset);
+    }
+    bytes.insert(bytes.end(), this->m_tickGaps.begin(), this->m_tickGaps.end()); // the first is the tick itself
+
+    vector<unsigned char> record;
+    record.push_back(RECORD_INDEX);
+    putVarint(record, 0);
+    putVarint(record, 0);
+    putVarint(record, 0);
+    putVarint(record, bytes.size());
+    record.insert(record.end(), bytes.begin(), bytes.end());
+
+    unsigned char footer[TRAJECTORY_FOOTER_SIZE];
+    putLittle(footer, this->m_offset);
+    memcpy(footer + 8, TRAJECTORY_INDEX_MAGIC, sizeof(TRAJECTORY_INDEX_MAGIC));
+    record.insert(record.end(), footer, footer + sizeof(footer));
+
+    this->m_out.write(reinterpret_cast<const char *>(record.data()), record.size());
+    this->m_offset += record.size();
+    this->m_bytesWritten = this->m_offset;
+}
+
+
+// class: TrajectoryReader
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+TrajectoryReader::TrajectoryReader() : m_data(nullptr),
+                                       m_size(0),
+                                       m_mapped(false),
+                                       m_quantum(1.0f),
+                                       m_arenaRadius(0.0f),
+                                       m_boidMass(1.0f),
+                                       m_tickSeconds(0.0),
+                                       m_current(-1),
+                                       m_next(0),
+                                       m_ticks{0, 0, 0},
+                                       m_step(0),
+                                       m_history(0),
+                                       m_sinceKeyframe(0) {}
+
+TrajectoryReader::~TrajectoryReader() {
+    this->close();
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool TrajectoryReader::isOpen() const { return this->m_data != nullptr; }
+const string &TrajectoryReader::getError() const { return this->m_error; }
+unsigned long TrajectoryReader::getFrameCount() const { return this->m_frameTicks.size(); }
+unsigned long TrajectoryReader::getTick(const unsigned long &a_frame) const { return this->m_frameTicks.at(a_frame); }
+float TrajectoryReader::getArenaRadius() const { return this->m_arenaRadius; }
+double TrajectoryReader::getTickSeconds() const { return this->m_tickSeconds; }
+const vector<TrajectoryKeyframe> &TrajectoryReader::getKeyframes() const { return this->m_keyframes; }
+
+
+/////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+
+/**
+ * To open a recording and read its index, or rebuild it if the recording
+ * was cut short. Returns false if it isn't a recording or has no frames.
+ */
+bool TrajectoryReader::open(const string &a_filename) {
+    this->close();
+    this->m_error.clear();
+
+#ifdef TRAJECTORY_MMAP
+    int fd = ::open(a_filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        this->m_error = "could not open " + a_filename;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < TRAJECTORY_HEADER_SIZE) {
+        ::close(fd);
+        this->m_error = a_filename + " isn't a trajectory recording";
+        return false;
+    }
+    void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        this->m_error = "could not map " + a_filename;
+        return false;
+    }
+    this->m_data = static_cast<const unsigned char *>(mapped);
+    this->m_size = info.st_size;
+    this->m_mapped = true;
+#else
+    ifstream in(a_filename, ios::binary | ios::ate);
+    if (!in) {
+        this->m_error = "could not open " + a_filename;
+        return false;
+    }
+    size_t size = in.tellg();
+    this->m_buffer.resize(size);
+    in.seekg(0);
+    if (size < TRAJECTORY_HEADER_SIZE || !in.read(reinterpret_cast<char *>(this->m_buffer.data()), size)) {
+        this->m_buffer.clear();
+        this->m_error = a_filename + " isn't a trajectory recording";
+        return false;
+    }
+    this->m_data = this->m_buffer.data();
+    this->m_size = size;
+#endif
+
+    const unsigned char *header = this->m_data;
+    if (memcmp(header, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC)) != 0) {
+        this->m_error = a_filename + " isn't a trajectory recording";
+        this->close();
+        return false;
+    }
+    if (getLittle<uint32_t>(header + HEADER_VERSION) != TRAJECTORY_VERSION) {
+        this->m_error = a_filename + " was recorded by another version";
+        this->close();
+        return false;
+    }
+    this->m_quantum = getLittle<float>(header + HEADER_QUANTUM);
+    this->m_arenaRadius = getLittle<float>(header + HEADER_ARENA_RADIUS);
+    this->m_boidMass = getLittle<float>(header + HEADER_BOID_MASS);
+    this->m_tickSeconds = getLittle<double>(header + HEADER_TICK_SECONDS);
+
+    if (!this->readIndex() && !this->scan()) {
+        this->m_error = a_filename + " is damaged";
+        this->close();
+        return false;
+    }
+    if (this->m_frameTicks.empty() || this->m_keyframes.empty() || this->m_keyframes[0].frame != 0) {
+        this->m_error = a_filename + " has no frames";
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * To let go of the recording.
+ */
+void TrajectoryReader::close() {
+#ifdef TRAJECTORY_MMAP
+    if (this->m_mapped)
+        munmap(const_cast<unsigned char *>(this->m_data), this->m_size);
+#endif
+    this->m_data = nullptr;
+    this->m_size = 0;
+    this->m_mapped = false;
+    this->m_buffer.clear();
+    this->m_buffer.shrink_to_fit();
+    this->m_frameTicks.clear();
+    this->m_keyframes.clear();
+    this->m_current = -1;
+    this->m_history = 0;
+    this->m_sinceKeyframe = 0;
+}
+
+/**
+ * To read frame a_frame (0 to getFrameCount() - 1) into a_snapshot. Going
+ * forward a frame at a time only decodes that frame; anywhere else starts
+ * from the keyframe before it. Returns false if it can't be read.
+ */
+bool TrajectoryReader::readFrame(const unsigned long &a_frame, SimulationSnapshot &a_snapshot) {
+    if (!this->isOpen() || a_frame >= this->m_frameTicks.size()) return false;
+
+    // start early enough to have the two frames before for the velocity
+    // and force, unless already on the way there
+    unsigned long from = a_frame < 2 ? 0 : a_frame - 2;
+    auto keyframe = std::upper_bound(this->m_keyframes.begin(), this->m_keyframes.end(), from,
+                                     [](unsigned long a_f, const TrajectoryKeyframe &a_k) { return a_f < a_k.frame; });
+    --keyframe;
+    long frame = long(a_frame);
+    if (this->m_current < 0 || this->m_current > frame || this->m_current < long(keyframe->frame)) {
+        this->m_next = keyframe->offset;
+        this->m_current = long(keyframe->frame) - 1;
+        this->m_history = 0;
+        this->m_sinceKeyframe = 0;
+    }
+    while (this->m_current < frame) {
+        if (!this->decodeNext()) {
+            this->m_current = -1;
+            return false;
+        }
+    }
+
+    TraceZone zone("trajectory frame");
+    unsigned int n = this->m_ids.size();
+    a_snapshot.ids = this->m_ids;
+    a_snapshot.positions.resize(n);
+    a_snapshot.velocities.resize(n);
+    a_snapshot.lastForces.resize(n);
+    a_snapshot.tick = this->m_ticks[0];
+    a_snapshot.step = this->m_step;
+
+    // velocities over the last gap, forces from the change between the two
+    float gap1 = float((this->m_ticks[0] - this->m_ticks[1]) * this->m_tickSeconds);
+    float gap2 = float((this->m_ticks[1] - this->m_ticks[2]) * this->m_tickSeconds);
+    float toVelocity1 = this->m_history >= 2 ? this->m_quantum / gap1 : 0.0f;
+    float toVelocity2 = this->m_history >= 3 ? this->m_quantum / gap2 : 0.0f;
+    float toForce = this->m_history >= 3 ? this->m_boidMass / (0.5f * (gap1 + gap2)) : 0.0f;
+
+    const int32_t *q0 = this->m_q[0].data(), *q1 = this->m_q[1].data(), *q2 = this->m_q[2].data();
+    float *p[3] = {a_snapshot.positions.x.data(), a_snapshot.positions.y.data(), a_snapshot.positions.z.data()};
+    float *v[3] = {a_snapshot.velocities.x.data(), a_snapshot.velocities.y.data(), a_snapshot.velocities.z.data()};
+    float *f[3] = {a_snapshot.lastForces.x.data(), a_snapshot.lastForces.y.data(), a_snapshot.lastForces.z.data()};
+    float quantum = this->m_quantum;
+    for (unsigned int i = 0; i < n; i++, q0 += 3, q1 += 3, q2 += 3) {
+        for (unsigned int c = 0; c < 3; c++) {
+            float velocity = this->m_history >= 2 ? float(q0[c] - q1[c]) * toVelocity1 : 0.0f;
+            p[c][i] = float(q0[c]) * quantum;
+            v[c][i] = velocity;
+            f[c][i] = this->m_history >= 3 ? (velocity - float(q1[c] - q2[c]) * toVelocity2) * toForce : 0.0f;
+        }
+    }
+    return true;
+}
+
+/**
+ * To find the last frame recorded at or before a_tick, frame 0 if a_tick
+ * is before them all.
+ */
+unsigned long TrajectoryReader::findFrame(const unsigned long &a_tick) const {
+    auto after = std::upper_bound(this->m_frameTicks.begin(), this->m_frameTicks.end(), a_tick);
+    return after == this->m_frameTicks.begin() ? 0 : (after - this->m_frameTicks.begin()) - 1;
+}
+
+/**
+ * To read the index the footer points at. Returns false if there isn't a
+ * whole one.
+ */
+bool TrajectoryReader::readIndex() {
+    if (this->m_size < TRAJECTORY_HEADER_SIZE + TRAJECTORY_FOOTER_SIZE) return false;
+    const unsigned char *footer = this->m_data + this->m_size - TRAJECTORY_FOOTER_SIZE;
+    uint64_t offset = getLittle<uint64_t>(footer);
+    if (memcmp(footer + 8, TRAJECTORY_INDEX_MAGIC, sizeof(TRAJECTORY_INDEX_MAGIC)) != 0 ||
+        offset < TRAJECTORY_HEADER_SIZE || offset >= this->m_size - TRAJECTORY_FOOTER_SIZE)
+        return false;
+
+    unsigned int kind;
+    unsigned long tick, step, count, length;
+    if (!this->readRecordHeader(offset, kind, tick, step, count, length) || kind != RECORD_INDEX)
+        return false;
+
+    const unsigned char *at = this->m_data + offset, *end = at + length;
+    uint64_t frames, keyframes;
+    if (!getVarint(at, end, frames) || !getVarint(at, end, keyframes) || keyframes > frames)
+        return false;
+    for (uint64_t k = 0; k < keyframes; k++) {
+        uint64_t frame, keyTick, keyOffset;
+        if (!getVarint(at, end, frame) || !getVarint(at, end, keyTick) || !getVarint(at, end, keyOffset) ||
+            frame >= frames || keyOffset >= offset)
+            return false;
+        this->m_keyframes.push_back({(unsigned long)frame, (unsigned long)keyTick, keyOffset});
+    }
+    unsigned long frameTick = 0;
+    for (uint64_t f = 0; f < frames; f++) {
+        uint64_t gap;
+        if (!getVarint(at, end, gap)) return false;
+        frameTick += (unsigned long)gap;
+        this->m_frameTicks.push_back(frameTick);
+    }
+    return true;
+}
+
+/**
+ * To walk the records from the first, noting the keyframes and the ticks,
+ * up to the first one that is cut short. Returns false if it fails before
+ * any.
+ */
+bool TrajectoryReader::scan() {
+    this->m_keyframes.clear();
+    this->m_frameTicks.clear();
+
+    uint64_t at = TRAJECTORY_HEADER_SIZE;
+    while (true) {
+        uint64_t offset = at;
+        unsigned int kind;
+        unsigned long tick, step, count, length;
+        if (!this->readRecordHeader(at, kind, tick, step, count, length) || kind == RECORD_INDEX)
+            break;
+        if (kind == RECORD_KEYFRAME)
+            this->m_keyframes.push_back({(unsigned long)this->m_frameTicks.size(), tick, offset});
+        else if (kind != RECORD_DELTA || this->m_keyframes.empty())
+            break;
+        this->m_frameTicks.push_back(tick);
+        at += length;
+    }
+    return !this->m_keyframes.empty();
+}
+
+/**
+ * To read the header of the record at a_at, moving a_at to its payload.
+ * Returns false if the record doesn't fit in the file.
+ */
+bool TrajectoryReader::readRecordHeader(uint64_t &a_at,
+                                        unsigned int &a_kind,
+                                        unsigned long &a_tick,
+                                        unsigned long &a_step,
+                                        unsigned long &a_count,
+                                        unsigned long &a_length) const {
+    if (a_at >= this->m_size) return false;
+    const unsigned char *at = this->m_data + a_at, *end = this->m_data + this->m_size;
+    unsigned int kind = *at++;
+    uint64_t tick, step, count, length;
+    if (!getVarint(at, end, tick) || !getVarint(at, end, step) || !getVarint(at, end, count) ||
+        !getVarint(at, end, length) || length > uint64_t(end - at))
+        return false;
+    a_at = at - this->m_data;
+    a_kind = kind;
+    a_tick = (unsigned long)tick;
+    a_step = (unsigned long)step;
+    a_count = (unsigned long)count;
+    a_length = (unsigned long)length;
+    return true;
+}
+
+/**
+ * To decode the frame at m_next into m_q[0], moving the ones before
+ * along.
+ */
+bool TrajectoryReader::decodeNext() {
+    TraceZone zone("trajectory decode");
+    uint64_t offset = this->m_next;
+    unsigned int kind;
+    unsigned long tick, step, count, length;
+    if (!this->readRecordHeader(offset, kind, tick, step, count, length) || kind == RECORD_INDEX)
+        return false;
+    if (kind == RECORD_DELTA && (this->m_sinceKeyframe == 0 || count != this->m_ids.size()))
+        return false;
+    if (3 * uint64_t(count) > length) // every coordinate takes a byte at least
+        return false;
+    this->m_next = offset + length;
+
+    std::swap(this->m_q[2], this->m_q[1]);
+    std::swap(this->m_q[1], this->m_q[0]);
+    this->m_ticks[2] = this->m_ticks[1];
+    this->m_ticks[1] = this->m_ticks[0];
+    this->m_ticks[0] = tick;
+    this->m_step = step;
+
+    vector<int32_t> &q = this->m_q[0];
+    q.resize(3 * count);
+    const unsigned char *at = this->m_data + offset, *end = at + length;
+    uint64_t v;
+    if (kind == RECORD_KEYFRAME) {
+        vector<signed int> ids(count);
+        int previous = -1;
+        for (unsigned long i = 0; i < count; i++) {
+            if (!getVarint(at, end, v)) return false;
+            previous += int(v) + 1;
+            ids[i] = previous;
+        }
+        for (int32_t &c : q) {
+            if (!getVarint(at, end, v)) return false;
+            c = int32_t(unzigzag(v));
+        }
+        // the same boids carry on, for the velocities
+        this->m_history = ids == this->m_ids ? std::min(this->m_history + 1, 3u) : 1;
+        this->m_ids = std::move(ids);
+        this->m_sinceKeyframe = 1;
+    } else {
+        const int32_t *q1 = this->m_q[1].data(), *q2 = this->m_q[2].data();
+        unsigned int frames = this->m_sinceKeyframe;
+        int64_t gap1 = int64_t(this->m_ticks[0] - this->m_ticks[1]);
+        int64_t gap2 = int64_t(this->m_ticks[1] - this->m_ticks[2]);
+        int32_t *out = q.data();
+        size_t values = q.size();
+        auto decode = [&](auto a_predict) {
+            for (size_t i = 0; i < values; i++) {
+                if (!getVarint(at, end, v)) return false;
+                out[i] = int32_t(unzigzag(v) + a_predict(i));
+            }
+            return true;
+        };
+        // the cases of predict() taken out of the loop, the common one is even ticks
+        bool decoded;
+        if (frames < 2)
+            decoded = decode([&](size_t i) { return int64_t(q1[i]); });
+        else if (gap1 == gap2)
+            decoded = decode([&](size_t i) { return 2 * int64_t(q1[i]) - q2[i]; });
+        else
+            decoded = decode([&](size_t i) { return predict(q1[i], q2[i], frames, gap1, gap2); });
+        if (!decoded) return false;
+        this->m_history = std::min(this->m_history + 1, 3u);
+        this->m_sinceKeyframe++;
+    }
+
+    this->m_current++;
+    return true;
+}
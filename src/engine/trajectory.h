@@ -0,0 +1,222 @@
+/**
+ * Filename: trajectory.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulationthread.h"
+
+using namespace std;
+
+
+constexpr uint32_t TRAJECTORY_VERSION = 2;
+
+// positions are stored in steps of the arena radius / 2^bits
+constexpr unsigned int TRAJECTORY_QUANTUM_BITS = 16;
+
+// frames between keyframes, the most a seek has to decode
+constexpr unsigned int TRAJECTORY_KEYFRAME_INTERVAL = 64;
+
+// frames that can wait for the writer thread before new ones are dropped
+constexpr unsigned int TRAJECTORY_QUEUE_FRAMES = 8;
+
+
+// where a keyframe is in a recording
+struct TrajectoryKeyframe {
+    unsigned long frame;
+    unsigned long tick;
+    uint64_t offset; // of its record in the file
+};
+
+
+/**
+ * Records the boid positions of a run to a file compactly enough to keep
+ * hours of it. Positions are quantized to a fraction of the arena radius
+ * and each frame is stored as the difference from a prediction continuing
+ * the last two frames along a straight line (which, for boids turning
+ * gently, is within a few steps), packed as zigzag varints. Every
+ * TRAJECTORY_KEYFRAME_INTERVAL frames, or when the boids change, a
+ * keyframe holds the IDs and absolute positions, and an index of the
+ * keyframes and the tick of every frame is written at the end for
+ * seeking. Velocities aren't stored, the reader works them out from
+ * consecutive positions. Frames are timed by the simulation thread's
+ * tick, a fixed amount of simulated time however many substeps it took.
+ *
+ * The file, little-endian: a 32 byte header, then one record per frame
+ * (kind, tick, substep count, boid count and payload length as varints,
+ * then the payload), then the index record and a 16 byte footer pointing
+ * at it. A recording cut short without an index can still be read.
+ *
+ * record() only copies the frame into a queue; a background thread does
+ * the encoding and the writing. If it falls behind the frame is dropped
+ * and the next one written is a keyframe.
+ */
+class TrajectoryRecorder {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    TrajectoryRecorder();
+    ~TrajectoryRecorder(); // stops recording
+
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isRecording() const;
+    const string &getFilename() const;
+    unsigned long getFrameCount() const; // written so far
+    unsigned long getDroppedCount() const; // came while the queue was full
+    unsigned long long getBytesWritten() const;
+    double getBytesPerBoidFrame() const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    bool start(const string &a_filename,
+               const float &a_arenaRadius,
+               const float &a_boidMass,
+               const double &a_tickSeconds);
+    void record(const SimulationSnapshot &a_snapshot); // never waits on the disk
+    bool stop(); // writes what is queued and the index, false if the file couldn't be written
+
+// private types
+private:
+    struct PendingFrame {
+        unsigned long tick;
+        unsigned long step;
+        vector<signed int> ids;
+        Vec3Column positions;
+        bool keyframe; // frames were dropped before it
+    };
+
+// private functions
+private:
+    void run();
+    void write(const PendingFrame &a_frame);
+    void writeIndex();
+
+// private variables
+private:
+    string m_filename;
+    ofstream m_out;
+    float m_quantum;
+    atomic<bool> m_recording;
+
+    // single producer, single consumer ring of frames
+    PendingFrame m_queue[TRAJECTORY_QUEUE_FRAMES];
+    atomic<unsigned long> m_head; // next frame for the writer
+    atomic<unsigned long> m_tail; // next free slot for record()
+    bool m_dropped; // producer only, makes the next frame a keyframe
+    unsigned long m_lastTick; // producer only, of the last frame queued
+    mutex m_wakeMutex;
+    condition_variable m_wake;
+    bool m_stopping;
+    thread m_thread;
+
+    // encoder state, writer thread only
+    vector<signed int> m_ids;
+    vector<int32_t> m_q[3]; // quantized xyz per boid of this frame and the two before
+    unsigned long m_ticks[3];
+    unsigned int m_history; // frames since the last keyframe, counting it, 0 before the first
+    vector<unsigned char> m_bytes;
+    vector<TrajectoryKeyframe> m_keyframes;
+    vector<unsigned char> m_tickGaps; // varint ticks from each frame to the next, for the index
+    uint64_t m_offset; // where the next record goes
+
+    atomic<unsigned long> m_frames;
+    atomic<unsigned long> m_droppedFrames;
+    atomic<unsigned long long> m_bytesWritten;
+    atomic<unsigned long long> m_boidFrames;
+
+}; // class TrajectoryRecorder
+
+
+/**
+ * Reads a recording back frame by frame, or from any frame by starting at
+ * the keyframe before it. The file is mapped into memory where that's
+ * possible and read into it otherwise.
+ */
+class TrajectoryReader {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    TrajectoryReader();
+    ~TrajectoryReader(); // unmaps
+
+    TrajectoryReader(const TrajectoryReader &) = delete;
+    TrajectoryReader &operator=(const TrajectoryReader &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isOpen() const;
+    const string &getError() const;
+    unsigned long getFrameCount() const;
+    unsigned long getTick(const unsigned long &a_frame) const; // it was recorded at
+    float getArenaRadius() const;
+    double getTickSeconds() const;
+    const vector<TrajectoryKeyframe> &getKeyframes() const;
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    bool open(const string &a_filename);
+    void close();
+
+    // positions, velocities and (mass times acceleration) forces of frame
+    // a_frame into a_snapshot, with the tick and substep count it was
+    // recorded at; the published time is left alone
+    bool readFrame(const unsigned long &a_frame, SimulationSnapshot &a_snapshot);
+    unsigned long findFrame(const unsigned long &a_tick) const; // last frame at or before a_tick
+
+// private functions
+private:
+    bool readIndex(); // from the footer
+    bool scan(); // rebuilds the index of a recording without one
+    bool readRecordHeader(uint64_t &a_at,
+                          unsigned int &a_kind,
+                          unsigned long &a_tick,
+                          unsigned long &a_step,
+                          unsigned long &a_count,
+                          unsigned long &a_length) const;
+    bool decodeNext(); // the record at m_next into the decoder state
+
+// private variables
+private:
+    const unsigned char *m_data; // whole file, mapped or in m_buffer
+    size_t m_size;
+    bool m_mapped;
+    vector<unsigned char> m_buffer;
+    string m_error;
+
+    float m_quantum;
+    float m_arenaRadius;
+    float m_boidMass;
+    double m_tickSeconds;
+    vector<unsigned long> m_frameTicks;
+    vector<TrajectoryKeyframe> m_keyframes;
+
+    // decoder state
+    long m_current; // frame in m_q[0], -1 for none
+    uint64_t m_next; // offset of the record after it
+    vector<signed int> m_ids;
+    vector<int32_t> m_q[3]; // quantized positions of the current frame and the two before
+    unsigned long m_ticks[3];
+    unsigned long m_step;
+    unsigned int m_history; // frames of the same boids in m_q, 0 to 3
+    unsigned int m_sinceKeyframe; // of those, frames since the last keyframe
+
+}; // class TrajectoryReader
+
+#endif // TRAJECTORY_H
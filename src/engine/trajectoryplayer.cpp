@@ -0,0 +1,274 @@
+/**
+ * Filename: trajectoryplayer.cpp
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#include <algorithm>
+#include <climits>
+#include "trajectoryplayer.h"
+#include "tracer.h"
+
+using namespace std;
+
+
+// slowest and fastest playback, times real time
+constexpr float MIN_PLAYBACK_SPEED = 0.05f;
+constexpr float MAX_PLAYBACK_SPEED = 16.0f;
+
+
+// class: TrajectoryPlayer
+
+///////////////////////////////////// CONSTRUCTOR /////////////////////////////////
+TrajectoryPlayer::TrajectoryPlayer() : m_time(0.0),
+                                       m_speed(1.0f),
+                                       m_paused(true),
+                                       m_readPrevious(-1),
+                                       m_readLatest(-1),
+                                       m_wanted(0),
+                                       m_stride(1),
+                                       m_alpha(0.0f),
+                                       m_failed(false),
+                                       m_running(false),
+                                       m_decodeTime(0.0) {
+    std::fill(this->m_slotFrames, this->m_slotFrames + PLAYER_SNAPSHOTS, -1L);
+}
+
+TrajectoryPlayer::~TrajectoryPlayer() {
+    this->close();
+}
+
+
+///////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+bool TrajectoryPlayer::isOpen() const { return this->m_running; }
+const string &TrajectoryPlayer::getError() const { return this->m_error; }
+unsigned long TrajectoryPlayer::getFrameCount() const { return this->m_reader.getFrameCount(); }
+float TrajectoryPlayer::getArenaRadius() const { return this->m_reader.getArenaRadius(); }
+double TrajectoryPlayer::getTime() const { return this->m_time; }
+float TrajectoryPlayer::getSpeed() const { return this->m_speed; }
+bool TrajectoryPlayer::isPaused() const { return this->m_paused; }
+double TrajectoryPlayer::getDecodeTime() const { return this->m_decodeTime.load(); }
+
+unsigned long TrajectoryPlayer::getFrame() const {
+    lock_guard<mutex> lock(this->m_mutex);
+    return this->m_wanted;
+}
+
+double TrajectoryPlayer::getDuration() const {
+    unsigned long frames = this->m_reader.getFrameCount();
+    if (frames == 0) return 0.0;
+    return (this->m_reader.getTick(frames - 1) - this->m_reader.getTick(0)) * this->m_reader.getTickSeconds();
+}
+
+void TrajectoryPlayer::setTime(const double &a_seconds) {
+    if (this->isOpen()) this->seek(a_seconds, false);
+}
+
+void TrajectoryPlayer::setSpeed(const float &a_speed) {
+    this->m_speed = std::min(std::max(a_speed, MIN_PLAYBACK_SPEED), MAX_PLAYBACK_SPEED);
+}
+
+void TrajectoryPlayer::setPaused(const bool &a_paused) {
+    this->m_paused = a_paused;
+    this->m_lastUpdate = chrono::steady_clock::now(); // the pause doesn't move the clock
+}
+
+
+/////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+
+/**
+ * To open a recording and start decoding from its first frame, paused.
+ * Returns false if it can't be read.
+ */
+bool TrajectoryPlayer::open(const string &a_filename) {
+    this->close();
+    if (!this->m_reader.open(a_filename)) {
+        this->m_error = this->m_reader.getError();
+        return false;
+    }
+
+    std::fill(this->m_slotFrames, this->m_slotFrames + PLAYER_SNAPSHOTS, -1L);
+    this->m_readPrevious = -1;
+    this->m_readLatest = -1;
+    this->m_failed = false;
+    this->m_paused = true;
+    this->seek(0.0, false);
+
+    this->m_running = true;
+    this->m_thread = thread(&TrajectoryPlayer::run, this);
+    return true;
+}
+
+/**
+ * To stop decoding and close the recording.
+ */
+void TrajectoryPlayer::close() {
+    {
+        lock_guard<mutex> lock(this->m_mutex);
+        this->m_running = false;
+    }
+    this->m_wake.notify_one();
+    if (this->m_thread.joinable())
+        this->m_thread.join();
+    this->m_reader.close();
+}
+
+/**
+ * To move the clock on by the wall time since the last update times the
+ * speed, unless paused. It stops at the last frame.
+ */
+void TrajectoryPlayer::update() {
+    auto now = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double>(now - this->m_lastUpdate).count();
+    this->m_lastUpdate = now;
+    if (!this->isOpen() || this->m_paused) return;
+
+    this->seek(this->m_time + elapsed * this->m_speed, true);
+}
+
+/**
+ * To get the decoded frames either side of the clock (the same one twice
+ * at the last frame, or the nearest decoded one while the decoding
+ * catches up) and how far to interpolate between them. They stay
+ * untouched until release() is called. Returns false if nothing has been
+ * decoded yet.
+ */
+bool TrajectoryPlayer::acquire(const SimulationSnapshot *&a_previous,
+                               const SimulationSnapshot *&a_latest,
+                               float &a_alpha) {
+    lock_guard<mutex> lock(this->m_mutex);
+    long wanted = long(this->m_wanted);
+    int previous = this->slotOf(wanted);
+    int latest = previous < 0 ? -1 : this->slotOf(wanted + 1);
+    a_alpha = latest < 0 ? 0.0f : this->m_alpha;
+
+    if (previous < 0) {
+        // the closest frame decoded instead, one before the clock if there
+        // is one so playing on doesn't go back
+        auto distance = [wanted](long a_frame) { return a_frame <= wanted ? wanted - a_frame : LONG_MAX / 2 + a_frame; };
+        for (unsigned int s = 0; s < PLAYER_SNAPSHOTS; s++) {
+            long frame = this->m_slotFrames[s];
+            if (frame >= 0 && (previous < 0 || distance(frame) < distance(this->m_slotFrames[previous])))
+                previous = s;
+        }
+        if (previous < 0) return false;
+    }
+    if (latest < 0) latest = previous;
+
+    this->m_readPrevious = previous;
+    this->m_readLatest = latest;
+    a_previous = &this->m_snapshots[previous];
+    a_latest = &this->m_snapshots[latest];
+    return true;
+}
+
+/**
+ * To hand the frames from acquire() back.
+ */
+void TrajectoryPlayer::release() {
+    {
+        lock_guard<mutex> lock(this->m_mutex);
+        this->m_readPrevious = -1;
+        this->m_readLatest = -1;
+    }
+    this->m_wake.notify_one(); // the slots may be needed
+}
+
+/**
+ * To keep the frames either side of the clock, and of where it will be
+ * after the next update, decoded, waiting while they are.
+ */
+void TrajectoryPlayer::run() {
+    Tracer::setThreadName("replay");
+
+    unique_lock<mutex> lock(this->m_mutex);
+    while (this->m_running) {
+        long needed[4];
+        unsigned int count = this->m_failed ? 0 : this->neededFrames(needed);
+        long next = -1;
+        for (unsigned int k = 0; k < count && next < 0; k++)
+            if (this->slotOf(needed[k]) < 0) next = needed[k];
+
+        // into a slot nobody is drawing and that isn't needed, the furthest
+        // from the clock first
+        long wanted = long(this->m_wanted);
+        int slot = -1;
+        for (unsigned int s = 0; next >= 0 && s < PLAYER_SNAPSHOTS; s++) {
+            long frame = this->m_slotFrames[s];
+            if (int(s) == this->m_readPrevious || int(s) == this->m_readLatest ||
+                std::find(needed, needed + count, frame) != needed + count)
+                continue;
+            if (slot < 0 || frame < 0 || std::labs(frame - wanted) > std::labs(this->m_slotFrames[slot] - wanted))
+                slot = s;
+            if (frame < 0) break;
+        }
+        if (slot < 0) {
+            this->m_wake.wait(lock);
+            continue;
+        }
+
+        this->m_slotFrames[slot] = -1;
+        lock.unlock();
+        auto start = chrono::steady_clock::now();
+        bool read = this->m_reader.readFrame(next, this->m_snapshots[slot]);
+        this->m_decodeTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        lock.lock();
+
+        if (read)
+            this->m_slotFrames[slot] = next;
+        else
+            this->m_failed = true;
+    }
+}
+
+/**
+ * To set the clock to a_seconds into the recording and work out the frame
+ * it is in. a_playing if it got there by playing rather than being set.
+ */
+void TrajectoryPlayer::seek(const double &a_seconds, const bool &a_playing) {
+    this->m_time = std::min(std::max(a_seconds, 0.0), this->getDuration());
+
+    double tick = this->m_reader.getTick(0) + this->m_time / this->m_reader.getTickSeconds();
+    unsigned long frame = this->m_reader.findFrame((unsigned long)tick);
+    float alpha = 0.0f;
+    if (frame + 1 < this->m_reader.getFrameCount()) {
+        double from = this->m_reader.getTick(frame), to = this->m_reader.getTick(frame + 1);
+        alpha = float(std::min(std::max((tick - from) / (to - from), 0.0), 1.0));
+    }
+
+    {
+        lock_guard<mutex> lock(this->m_mutex);
+        if (frame != this->m_wanted) this->m_failed = false;
+        this->m_stride = a_playing && frame > this->m_wanted ? frame - this->m_wanted : 1;
+        this->m_wanted = frame;
+        this->m_alpha = alpha;
+    }
+    this->m_wake.notify_one();
+}
+
+/**
+ * To find the slot holding a_frame, -1 if none does. Called with m_mutex
+ * held.
+ */
+int TrajectoryPlayer::slotOf(const long &a_frame) const {
+    for (unsigned int s = 0; s < PLAYER_SNAPSHOTS; s++)
+        if (this->m_slotFrames[s] == a_frame) return s;
+    return -1;
+}
+
+/**
+ * To list the frames that should be decoded: the two either side of the
+ * clock, then the two either side of where the clock will be next if it
+ * moves as far as it last did. Called with m_mutex held.
+ */
+unsigned int TrajectoryPlayer::neededFrames(long a_frames[4]) const {
+    long frames = long(this->m_reader.getFrameCount());
+    long candidates[4] = {long(this->m_wanted), long(this->m_wanted) + 1,
+                          long(this->m_wanted + this->m_stride), long(this->m_wanted + this->m_stride) + 1};
+    unsigned int count = 0;
+    for (long frame : candidates)
+        if (frame < frames && std::find(a_frames, a_frames + count, frame) == a_frames + count)
+            a_frames[count++] = frame;
+    return count;
+}
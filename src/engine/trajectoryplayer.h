@@ -0,0 +1,115 @@
+/**
+ * Filename: trajectoryplayer.h
+ * Author: Glenn Skelton
+ *
+ * Last Modified: October 18, 2026
+ */
+
+#ifndef TRAJECTORYPLAYER_H
+#define TRAJECTORYPLAYER_H
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "trajectory.h"
+
+using namespace std;
+
+
+// decoded frames kept: the two being drawn, the two either side of the
+// clock and the two either side of where it will be at the next update
+constexpr unsigned int PLAYER_SNAPSHOTS = 6;
+
+
+/**
+ * Plays a trajectory recording back in place of a SimulationThread: a
+ * clock moves through the recording at some multiple of real time, and a
+ * thread decodes the frames around it into snapshots. The two either side
+ * of the clock are handed out with acquire() and release() the same way
+ * the simulation's are, so the renderer draws them interpolated the same
+ * way.
+ *
+ * The clock is moved from one thread (the one calling update()); it can be
+ * paused, sped up or slowed down, or set anywhere, in which case the
+ * decoding starts over from the keyframe before. Until that frame is
+ * decoded the last one is shown.
+ */
+class TrajectoryPlayer {
+// public functions
+public:
+    ////////////////////////////////// CONSTRUCTORS /////////////////////////////////
+    TrajectoryPlayer();
+    ~TrajectoryPlayer(); // closes
+
+    TrajectoryPlayer(const TrajectoryPlayer &) = delete;
+    TrajectoryPlayer &operator=(const TrajectoryPlayer &) = delete;
+
+
+    //////////////////////////////// GETTERS/SETTERS ////////////////////////////////
+    bool isOpen() const;
+    const string &getError() const;
+    unsigned long getFrameCount() const;
+    unsigned long getFrame() const; // last frame at or before the clock
+    float getArenaRadius() const;
+    double getDuration() const; // seconds from the first frame to the last
+    double getTime() const; // seconds since the first frame
+    float getSpeed() const;
+    bool isPaused() const;
+    double getDecodeTime() const; // ms the last frame took to decode
+
+    void setTime(const double &a_seconds);
+    void setSpeed(const float &a_speed);
+    void setPaused(const bool &a_paused);
+
+
+    /////////////////////////////// HELPER FUNCTIONS ///////////////////////////////////
+    bool open(const string &a_filename); // starts the decoding, paused at the start
+    void close();
+    void update(); // moves the clock on by the time since the last update
+
+    bool acquire(const SimulationSnapshot *&a_previous,
+                 const SimulationSnapshot *&a_latest,
+                 float &a_alpha);
+    void release();
+
+// private functions
+private:
+    void run();
+    void seek(const double &a_seconds, const bool &a_playing); // sets the clock and the wanted frame
+    int slotOf(const long &a_frame) const;
+    unsigned int neededFrames(long a_frames[4]) const; // to have decoded, nearest the clock first
+
+// private variables
+private:
+    TrajectoryReader m_reader; // decoding thread only while open, but for the frame ticks
+    string m_error;
+
+    // playback clock, updating thread only
+    double m_time;
+    float m_speed;
+    bool m_paused;
+    chrono::steady_clock::time_point m_lastUpdate;
+
+    // decoded frames, guarded by m_mutex
+    mutable mutex m_mutex;
+    condition_variable m_wake;
+    SimulationSnapshot m_snapshots[PLAYER_SNAPSHOTS];
+    long m_slotFrames[PLAYER_SNAPSHOTS]; // frame in each, -1 for none (or being decoded)
+    int m_readPrevious; // handed out by acquire(), -1 for none
+    int m_readLatest;
+    unsigned long m_wanted; // frame the clock is in
+    unsigned long m_stride; // frames it moved at the last update, at least 1
+    float m_alpha; // how far the clock is to the frame after
+    bool m_failed; // the wanted frame couldn't be read, don't retry until it changes
+    bool m_running;
+    thread m_thread;
+
+    atomic<double> m_decodeTime;
+
+}; // class TrajectoryPlayer
+
+#endif // TRAJECTORYPLAYER_H
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+// Filename: headless.cpp
+//
+// Author: Glenn Skelton
+//
+// Last modified: October 18, 2026
+//
+// Runs the flocking simulation without a window or GL context and reports
+// how many boid-steps per second it manages, along with the cache misses of
+// the run where the platform can count them. With adaptive substeps on the
+// same simulated time is covered in frames of INTEGRATION substeps' length
+// and the substeps they actually took are reported. Given a checkpoint in
+// place of the config it carries on from there, and it can write one at
+// the end of the run.
+//
+// usage: boids_headless [substeps] [config or checkpoint file] [trace file]
+//                       [checkpoint to write]
+//------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include "checkpoint.h"
+#include "parser.h"
+#include "perfcounter.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "simulation.h"
+
+using namespace std;
+using namespace givr::fileIO;
+
+
+int main(int argc, char *argv[]) {
+    unsigned long steps = INTEGRATION * 60; // a second of frames by default
+    string config = "configFiles/config.txt";
+    string traceFile; // no trace unless given
+    string checkpointFile; // none written unless given
+
+    if (argc > 1) steps = strtoul(argv[1], nullptr, 10);
+    if (argc > 2) config = argv[2];
+    if (argc > 3) traceFile = argv[3];
+    if (argc > 4) checkpointFile = argv[4];
+
+    if (steps == 0) {
+        cout << "usage: " << argv[0] << " [substeps] [config or checkpoint file] [trace file] [checkpoint to write]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // a checkpoint carries its own parameters
+    struct ProgramParameters params;
+    Checkpoint checkpoint;
+    auto loadStart = chrono::steady_clock::now();
+    if (checkpoint.open(config)) {
+        checkpoint.getParameters(params);
+    } else if (!parseConfigFile(params, config)) {
+        cout << "could not read " << config << endl;
+        return EXIT_FAILURE;
+    }
+
+    CacheMissCounter cacheMisses; // before the simulation starts its workers
+    Tracer::setThreadName("main");
+    Simulation sim(params);
+    if (checkpoint.isOpen()) {
+        checkpoint.restore(sim);
+        checkpoint.close();
+        cout << "resumed from " << config << " at substep " << sim.getStepCount() << " in "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - loadStart).count() << " ms" << endl;
+    } else {
+        sim.spawnBoids(static_cast<unsigned>(time(0)));
+    }
+
+    // the whole run is timed as one frame to break it down by phase
+    Profiler profiler;
+    profiler.setEnabled(true);
+    sim.setProfiler(&profiler);
+
+    cout << sim.getBoids().size() << " boids, " << steps << " substeps, "
+         << sim.getThreadCount() << " threads, "
+         << pairKernelName(sim.getPairKernel()) << " pair kernel" << endl;
+
+    unsigned long long missesBefore = cacheMisses.read();
+    auto start = chrono::steady_clock::now();
+    profiler.beginFrame();
+    Tracer::setEnabled(!traceFile.empty());
+    unsigned long substeps = steps, frames = 0;
+    if (params.adaptiveSubsteps) {
+        substeps = 0;
+        for (frames = 0; frames * INTEGRATION < steps; frames++)
+            substeps += sim.advanceFrame(INTEGRATION * DELTA_T, INTEGRATION);
+    } else {
+        sim.advance(steps, DELTA_T);
+    }
+    Tracer::setEnabled(false);
+    profiler.endFrame();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    unsigned long long misses = cacheMisses.read() - missesBefore;
+
+    double boidSteps = static_cast<double>(sim.getBoids().size()) * substeps;
+    cout << "elapsed: " << seconds << " s" << endl;
+    for (unsigned int p = 0; p < profiler.getPhaseCount(); p++) {
+        double ms = profiler.getStats(p).avg;
+        cout << "  " << profiler.getPhaseName(p) << ": " << ms << " ms ("
+             << 100.0 * ms / (seconds * 1000.0) << "%)" << endl;
+    }
+    if (params.neighbourSearch == NeighbourSearch::Verlet) {
+        const NeighbourList &lists = sim.getNeighbourList();
+        cout << "neighbour lists: " << lists.getRebuildCount() << " rebuilds, "
+             << lists.getReuseCount() << " rebuilds avoided" << endl;
+        if (params.farForceInterval > 1) {
+            const NeighbourList &near = sim.getNearNeighbourList();
+            cout << "near neighbour lists: " << near.getRebuildCount() << " rebuilds, "
+                 << near.getReuseCount() << " rebuilds avoided" << endl;
+        }
+    }
+    if (params.farForceInterval > 1)
+        cout << "far forces: every " << params.farForceInterval << " substeps" << endl;
+    if (params.adaptiveSubsteps)
+        cout << "adaptive substeps: " << substeps << " over " << frames << " frames, "
+             << static_cast<double>(substeps) / frames << " per frame ("
+             << 100.0 * (1.0 - static_cast<double>(substeps) / (frames * INTEGRATION))
+             << "% saved against " << INTEGRATION << ")" << endl;
+    if (params.reorderInterval != 0)
+        cout << "morton reorders: " << sim.getReorderCount() << " (every "
+             << params.reorderInterval << " substeps)" << endl;
+    if (cacheMisses.isAvailable())
+        cout << "cache misses: " << misses << " (" << misses / boidSteps << " per boid-step)" << endl;
+    else
+        cout << "cache misses: not available on this system" << endl;
+    if (!traceFile.empty()) {
+        if (Tracer::write(traceFile))
+            cout << "trace: " << Tracer::getEventCount() << " zones written to " << traceFile
+                 << " (" << Tracer::getDroppedCount() << " dropped)" << endl;
+        else
+            cout << "could not write " << traceFile << endl;
+    }
+    cout << "throughput: " << boidSteps / seconds << " boid-steps/s ("
+         << (seconds * 1e9) / boidSteps << " ns per boid-step)" << endl;
+    if (!checkpointFile.empty()) {
+        string error;
+        if (Checkpoint::save(sim, checkpointFile, &error))
+            cout << "checkpoint: substep " << sim.getStepCount() << " written to " << checkpointFile << endl;
+        else
+            cout << error << endl;
+    }
+
+    params.graphValues->clear();
+    delete params.graphValues;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,476 @@
+//------------------------------------------------------------------------------
+// Filename: sweep.cpp
+//
+// Author: Glenn Skelton
+//
+// Last modified: October 18, 2026
+//
+// Parameter sweep runner. Reads a sweep spec naming ranges of parameters,
+// runs a headless simulation for every combination of them (several times
+// with different seeds if asked), as many at once as there are cores, and
+// reports how each one flocked along with how fast it ran. Every run gets
+// one worker thread so the runs themselves are what run in parallel.
+//
+// The spec uses the config file syntax, one setting per line:
+//   config: configFiles/config.txt   parameters the sweep starts from
+//   substeps: 4800                   length of each run
+//   seeds: 2                         runs of each combination
+//   seed: 587                        the seeds are derived from this
+//   avoidance-range: 1.5, 2.5, 5     from, to and count of evenly spaced values
+//   mass: 0.2                        a single value overrides the config
+//
+// usage: boids_sweep [spec file] [--jobs N] [--csv file]
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "parser.h"
+#include "simulation.h"
+#include "spatialgrid.h"
+
+using namespace std;
+using namespace givr::fileIO;
+
+
+// a parameter that can be swept, by its name in the spec
+struct SweepField {
+    const char *name;
+    void (*set)(struct ProgramParameters &, double);
+};
+
+// the values a spec gives one field
+struct SweepAxis {
+    const SweepField *field;
+    vector<double> values;
+};
+
+// a whole spec
+struct SweepSpec {
+    string config = "configFiles/config.txt";
+    unsigned long substeps = INTEGRATION * 60 * 5; // five seconds of frames
+    unsigned int seeds = 1;
+    unsigned int seed = 587;
+    vector<SweepAxis> axes;
+};
+
+// how a flock looks at one moment
+struct FlockMetrics {
+    double order; // length of the mean heading, 1 when every boid flies the same way
+    double milling; // length of the mean angular heading about the centre, 1 for a ring
+    double speed; // mean speed
+    double nearest; // mean distance to the nearest boid within max range
+    double neighbours; // mean boids within max range
+};
+
+// one simulation of the sweep
+struct SweepRun {
+    unsigned int point; // combination of values, an index into each axis in turn
+    unsigned int replicate;
+    unsigned int seed;
+    FlockMetrics metrics;
+    unsigned int boids;
+    unsigned long substeps;
+    double seconds; // stepping only, not measuring
+    double nsPerBoidStep;
+};
+
+
+// the metrics are averaged over this many samples spread over the last
+// quarter of each run, the flock is still forming before that
+constexpr unsigned int METRIC_SAMPLES = 8;
+
+const SweepField SWEEP_FIELDS[] = {
+    {"boids", [](ProgramParameters &p, double v) { p.numBoids = static_cast<unsigned int>(std::lround(v)); }},
+    {"mass", [](ProgramParameters &p, double v) { p.boidMass = float(v); }},
+    {"avoidance-range", [](ProgramParameters &p, double v) { p.avoidanceRange = float(v); }},
+    {"cohesion-range", [](ProgramParameters &p, double v) { p.cohesionRange = float(v); }},
+    {"max-range", [](ProgramParameters &p, double v) { p.maxSearchRange = float(v); }},
+    {"avoidance-force", [](ProgramParameters &p, double v) { p.avoidanceMultiplier = float(v); }},
+    {"cohesion-force", [](ProgramParameters &p, double v) { p.cohesionMultiplier = float(v); }},
+    {"gather-force", [](ProgramParameters &p, double v) { p.gatherMultiplier = float(v); }},
+    {"arena", [](ProgramParameters &p, double v) { p.arenaRadius = float(v); }},
+    {"force", [](ProgramParameters &p, double v) { p.forceMultiplier = float(v); }},
+    {"min-velocity", [](ProgramParameters &p, double v) { p.minVelocity = float(v); }},
+    {"max-velocity", [](ProgramParameters &p, double v) { p.maxVelocity = float(v); }},
+    {"neighbour-skin", [](ProgramParameters &p, double v) { p.neighbourSkin = float(v); }},
+    {"far-force-interval", [](ProgramParameters &p, double v) { p.farForceInterval = static_cast<unsigned int>(std::lround(v)); }},
+    {"substep-travel", [](ProgramParameters &p, double v) { p.substepTravel = float(v); }},
+    {"substep-turn", [](ProgramParameters &p, double v) { p.substepTurn = float(v); }},
+};
+
+
+/**
+ * To read a sweep spec. Returns false, with the reason in a_error, if a
+ * line can't be understood.
+ */
+bool parseSweepSpec(SweepSpec &a_spec, const string &a_filename, string &a_error) {
+    ifstream iFile(configPath(a_filename));
+    if (!iFile.is_open()) {
+        a_error = "could not read " + a_filename;
+        return false;
+    }
+
+    string line;
+    for (unsigned int number = 1; getline(iFile, line); number++) {
+        size_t colon = line.find(':');
+        if (line.empty() || line[0] == '#') continue;
+        if (colon == string::npos) {
+            a_error = a_filename + ":" + to_string(number) + ": expected name: value";
+            return false;
+        }
+        string name = line.substr(0, colon);
+        string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+
+        if (name == "config") {
+            a_spec.config = value;
+            continue;
+        } else if (name == "substeps") {
+            a_spec.substeps = strtoul(value.c_str(), nullptr, 10);
+            continue;
+        } else if (name == "seeds") {
+            a_spec.seeds = std::max(1ul, strtoul(value.c_str(), nullptr, 10));
+            continue;
+        } else if (name == "seed") {
+            a_spec.seed = static_cast<unsigned int>(strtoul(value.c_str(), nullptr, 10));
+            continue;
+        }
+
+        const SweepField *field = nullptr;
+        for (const SweepField &f : SWEEP_FIELDS)
+            if (name == f.name) field = &f;
+
+        double from, to;
+        unsigned int count = 1;
+        int read = field == nullptr ? 0 : sscanf(value.c_str(), "%lf, %lf, %u", &from, &to, &count);
+        if (read != 1 && (read != 3 || count == 0)) {
+            a_error = a_filename + ":" + to_string(number) + ": " +
+                      (field == nullptr ? "no parameter called " + name : "expected a value or from, to, count");
+            return false;
+        }
+
+        SweepAxis axis;
+        axis.field = field;
+        for (unsigned int i = 0; i < count; i++)
+            axis.values.push_back(count == 1 ? from : from + (to - from) * i / (count - 1));
+        a_spec.axes.push_back(axis);
+    }
+    return true;
+}
+
+/**
+ * To find the index into each axis of combination a_point, the last axis
+ * changing fastest.
+ */
+vector<unsigned int> pointIndices(const SweepSpec &a_spec, unsigned int a_point) {
+    vector<unsigned int> indices(a_spec.axes.size());
+    for (unsigned int a = a_spec.axes.size(); a-- > 0;) {
+        indices[a] = a_point % a_spec.axes[a].values.size();
+        a_point /= a_spec.axes[a].values.size();
+    }
+    return indices;
+}
+
+/**
+ * To measure the flock in a_sim. a_grid is scratch space for finding the
+ * boids near each other.
+ */
+FlockMetrics measureFlock(const Simulation &a_sim, SpatialGrid &a_grid) {
+    const BoidStore &boids = a_sim.getBoids();
+    const ProgramParameters &params = a_sim.getParameters();
+    const Vec3Column &p = boids.positions();
+    const Vec3Column &v = boids.velocities();
+    unsigned int n = boids.size();
+
+    FlockMetrics metrics = {0.0, 0.0, 0.0, 0.0, 0.0};
+    if (n == 0) return metrics;
+
+    vec3f centre(0.0f, 0.0f, 0.0f);
+    for (unsigned int s = 0; s < n; s++)
+        centre += p.get(s);
+    centre /= float(n);
+
+    vec3f heading(0.0f, 0.0f, 0.0f), turning(0.0f, 0.0f, 0.0f);
+    for (unsigned int s = 0; s < n; s++) {
+        vec3f velocity = v.get(s);
+        float speed = length(velocity);
+        metrics.speed += speed;
+        if (speed == 0.0f) continue;
+        heading += velocity / speed;
+
+        vec3f offset = p.get(s) - centre;
+        float distance = length(offset);
+        if (distance > 0.0f) turning += cross(offset / distance, velocity / speed);
+    }
+    metrics.order = length(heading) / n;
+    metrics.milling = length(turning) / n;
+    metrics.speed /= n;
+
+    // nearest boid and boids within max range, from the cells around each
+    float range = params.maxSearchRange;
+    a_grid.rebuild(boids, range, params.arenaRadius + range);
+    unsigned int withNeighbour = 0;
+    for (unsigned int s = 0; s < n; s++) {
+        vec3f at = p.get(s);
+        float nearest = range * range;
+        unsigned int within = 0;
+        a_grid.forEachNeighbour(at, [&](unsigned int a_other) {
+            if (a_other == s) return;
+            vec3f d = p.get(a_other) - at;
+            float d2 = dot(d, d);
+            if (d2 < range * range) {
+                within++;
+                nearest = std::min(nearest, d2);
+            }
+        });
+        metrics.neighbours += within;
+        if (within > 0) {
+            metrics.nearest += std::sqrt(nearest);
+            withNeighbour++;
+        }
+    }
+    metrics.neighbours /= n;
+    metrics.nearest = withNeighbour > 0 ? metrics.nearest / withNeighbour : range;
+    return metrics;
+}
+
+/**
+ * To advance a_sim by a_substeps, in frames of INTEGRATION substeps'
+ * length when adaptive substeps are on. Returns the substeps taken.
+ */
+unsigned long advanceSubsteps(Simulation &a_sim, const unsigned long &a_substeps) {
+    if (!a_sim.getParameters().adaptiveSubsteps) {
+        a_sim.advance(a_substeps, DELTA_T);
+        return a_substeps;
+    }
+
+    unsigned long taken = 0;
+    for (unsigned long covered = 0; covered < a_substeps; covered += INTEGRATION)
+        taken += a_sim.advanceFrame(INTEGRATION * DELTA_T, INTEGRATION);
+    return taken;
+}
+
+/**
+ * To simulate one run of the sweep on the calling thread and measure it.
+ */
+void runSweep(const SweepSpec &a_spec, const struct ProgramParameters &a_base, SweepRun &a_run) {
+    struct ProgramParameters params = a_base;
+    params.numThreads = 1; // the runs are spread over the cores, not the pairs of one
+    vector<unsigned int> indices = pointIndices(a_spec, a_run.point);
+    for (unsigned int a = 0; a < a_spec.axes.size(); a++)
+        a_spec.axes[a].field->set(params, a_spec.axes[a].values[indices[a]]);
+
+    Simulation sim(params);
+    sim.spawnBoids(a_run.seed);
+    SpatialGrid grid;
+
+    // settle for three quarters of the run, measure through the rest
+    unsigned long settle = a_spec.substeps - a_spec.substeps / 4;
+    unsigned long sample = std::max(1ul, (a_spec.substeps - settle) / METRIC_SAMPLES);
+    FlockMetrics sum = {0.0, 0.0, 0.0, 0.0, 0.0};
+
+    auto start = chrono::steady_clock::now();
+    a_run.substeps = advanceSubsteps(sim, settle);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (unsigned int i = 0; i < METRIC_SAMPLES; i++) {
+        start = chrono::steady_clock::now();
+        a_run.substeps += advanceSubsteps(sim, sample);
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        FlockMetrics metrics = measureFlock(sim, grid);
+        sum.order += metrics.order;
+        sum.milling += metrics.milling;
+        sum.speed += metrics.speed;
+        sum.nearest += metrics.nearest;
+        sum.neighbours += metrics.neighbours;
+    }
+
+    a_run.metrics = {sum.order / METRIC_SAMPLES, sum.milling / METRIC_SAMPLES, sum.speed / METRIC_SAMPLES,
+                     sum.nearest / METRIC_SAMPLES, sum.neighbours / METRIC_SAMPLES};
+    a_run.boids = sim.getBoids().size();
+    a_run.seconds = seconds;
+    a_run.nsPerBoidStep = (seconds * 1e9) / (static_cast<double>(std::max(a_run.boids, 1u)) * a_run.substeps);
+}
+
+/**
+ * To check the ranges and velocities of a combination are in order, the
+ * force tables assume avoidance < cohesion < max range.
+ */
+bool isValidPoint(const SweepSpec &a_spec, const struct ProgramParameters &a_base, const unsigned int &a_point) {
+    struct ProgramParameters params = a_base;
+    vector<unsigned int> indices = pointIndices(a_spec, a_point);
+    for (unsigned int a = 0; a < a_spec.axes.size(); a++)
+        a_spec.axes[a].field->set(params, a_spec.axes[a].values[indices[a]]);
+
+    return params.numBoids > 0 && params.arenaRadius > 0.0f &&
+           0.0f < params.avoidanceRange && params.avoidanceRange < params.cohesionRange &&
+           params.cohesionRange < params.maxSearchRange &&
+           params.minVelocity <= params.maxVelocity;
+}
+
+/**
+ * To write every run out as CSV, one row each.
+ */
+bool writeCSV(const SweepSpec &a_spec, const vector<SweepRun> &a_runs, const string &a_filename) {
+    ofstream oFile(a_filename);
+    if (!oFile.is_open()) return false;
+
+    oFile << "point,replicate,seed";
+    for (const SweepAxis &axis : a_spec.axes)
+        oFile << "," << axis.field->name;
+    oFile << ",order,milling,speed,nearest,neighbours,boids,substeps,seconds,ns_per_boid_step\n";
+
+    for (const SweepRun &r : a_runs) {
+        oFile << r.point << "," << r.replicate << "," << r.seed;
+        vector<unsigned int> indices = pointIndices(a_spec, r.point);
+        for (unsigned int a = 0; a < a_spec.axes.size(); a++)
+            oFile << "," << a_spec.axes[a].values[indices[a]];
+        oFile << "," << r.metrics.order << "," << r.metrics.milling << "," << r.metrics.speed
+              << "," << r.metrics.nearest << "," << r.metrics.neighbours << "," << r.boids
+              << "," << r.substeps << "," << r.seconds << "," << r.nsPerBoidStep << "\n";
+    }
+    return true;
+}
+
+
+int main(int argc, char *argv[]) {
+    string specFile = "configFiles/sweep.txt";
+    unsigned int jobs = std::max(1u, thread::hardware_concurrency());
+    string csvFile = "boids_sweep.csv";
+
+    int i = 1;
+    if (argc > 1 && argv[1][0] != '-') specFile = argv[i++];
+    for (; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--jobs") == 0) jobs = std::max(1ul, strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--csv") == 0) csvFile = argv[i + 1];
+        else break;
+    }
+    if (i < argc) {
+        cout << "usage: " << argv[0] << " [spec file] [--jobs N] [--csv file]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    SweepSpec spec;
+    string error;
+    if (!parseSweepSpec(spec, specFile, error)) {
+        cout << error << endl;
+        return EXIT_FAILURE;
+    }
+    struct ProgramParameters base;
+    if (!parseConfigFile(base, spec.config)) {
+        cout << "could not read " << spec.config << endl;
+        return EXIT_FAILURE;
+    }
+
+    // every valid combination, seeds times over, each seed from the spec's
+    // seed, the combination and the replicate so adding an axis or a seed
+    // leaves the other runs' seeds alone
+    unsigned int points = 1;
+    for (const SweepAxis &axis : spec.axes)
+        points *= axis.values.size();
+    vector<SweepRun> runs;
+    unsigned int skipped = 0;
+    for (unsigned int point = 0; point < points; point++) {
+        if (!isValidPoint(spec, base, point)) {
+            skipped++;
+            continue;
+        }
+        for (unsigned int replicate = 0; replicate < spec.seeds; replicate++) {
+            seed_seq sequence{spec.seed, point, replicate};
+            unsigned int seed;
+            sequence.generate(&seed, &seed + 1);
+
+            SweepRun run = {};
+            run.point = point;
+            run.replicate = replicate;
+            run.seed = seed;
+            runs.push_back(run);
+        }
+    }
+    jobs = std::min(jobs, std::max(1u, static_cast<unsigned int>(runs.size())));
+
+    cout << runs.size() << " runs of " << spec.substeps << " substeps (" << points << " combinations x "
+         << spec.seeds << " seeds";
+    if (skipped > 0) cout << ", " << skipped << " combinations skipped for out of order ranges or velocities";
+    cout << ") on " << jobs << " threads" << endl;
+
+    // each job takes the next run not started until there are none
+    atomic<unsigned int> next(0);
+    mutex printMutex;
+    unsigned int finished = 0;
+    auto work = [&]() {
+        for (unsigned int r = next++; r < runs.size(); r = next++) {
+            runSweep(spec, base, runs[r]);
+
+            lock_guard<mutex> lock(printMutex);
+            finished++;
+            printf("\r%u of %zu runs done", finished, runs.size());
+            fflush(stdout);
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (unsigned int j = 1; j < jobs; j++)
+        threads.emplace_back(work);
+    work();
+    for (thread &t : threads)
+        t.join();
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("\n\n");
+
+    // one row per combination, the metrics and throughput averaged over its seeds
+    for (const SweepAxis &axis : spec.axes)
+        printf("%16s ", axis.field->name);
+    printf("%6s %6s %7s %7s %8s %7s %7s %14s\n",
+           "order", "mill", "speed", "nearest", "neighbrs", "boids", "runs", "ns/boid-step");
+
+    double runSeconds = 0.0, boidSteps = 0.0;
+    for (unsigned int first = 0; first < runs.size();) {
+        unsigned int last = first;
+        FlockMetrics mean = {0.0, 0.0, 0.0, 0.0, 0.0};
+        double ns = 0.0;
+        for (; last < runs.size() && runs[last].point == runs[first].point; last++) {
+            const SweepRun &r = runs[last];
+            mean.order += r.metrics.order;
+            mean.milling += r.metrics.milling;
+            mean.speed += r.metrics.speed;
+            mean.nearest += r.metrics.nearest;
+            mean.neighbours += r.metrics.neighbours;
+            ns += r.nsPerBoidStep;
+            runSeconds += r.seconds;
+            boidSteps += static_cast<double>(r.boids) * r.substeps;
+        }
+        unsigned int count = last - first;
+
+        vector<unsigned int> indices = pointIndices(spec, runs[first].point);
+        for (unsigned int a = 0; a < spec.axes.size(); a++)
+            printf("%16g ", spec.axes[a].values[indices[a]]);
+        printf("%6.3f %6.3f %7.2f %7.3f %8.2f %7u %7u %14.1f\n",
+               mean.order / count, mean.milling / count, mean.speed / count,
+               mean.nearest / count, mean.neighbours / count, runs[first].boids, count, ns / count);
+        first = last;
+    }
+
+    cout << endl << "wall time: " << wall << " s for " << runSeconds << " s of simulation ("
+         << (wall > 0.0 ? runSeconds / wall : 0.0) << "x), " << boidSteps / wall << " boid-steps/s overall" << endl;
+
+    if (writeCSV(spec, runs, csvFile)) cout << "runs written to " << csvFile << endl;
+    else cout << "could not write " << csvFile << endl;
+
+    base.graphValues->clear();
+    delete base.graphValues;
+
+    return EXIT_SUCCESS;
+}
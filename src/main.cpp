@@ -21,7 +21,13 @@
 #include "panel.h"
 #include "turntable_controls.h"
 #include "boid.h"
+#include "checkpoint.h"
+#include "configwatcher.h"
 #include "parser.h"
+#include "simulation.h"
+#include "simulationthread.h"
+#include "trajectory.h"
+#include "trajectoryplayer.h"
 #include <ctime>
 #include <cstdlib>
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -38,33 +44,65 @@ struct ProgramParameters params;
 
 
 // GLOBAL CONSTANTS/STATE
-constexpr float DELTA_T = 0.001;   // seconds (time step) 0.05
-constexpr unsigned int INTEGRATION = 16; // number of integrations
-const vec3f GRAVITY(0.0, 9.81, 0.0);
+const vec3f GRAVITY(0.0, 9.81, 0.0); // added to the last force to orient the boids
 
 bool PAUSED = false;
 bool OBSTACLE_MODE = false;
+bool VSYNC = true;
 
-
-// FUNCTION DEFINITIONS
-float randomFloatGenerator(const float &lower, const float &upper);
+const char *CONFIG_FILE = "configFiles/config.txt"; // read at startup and again whenever it is saved
+const char *PROFILE_FILE = "frame_timings.csv"; // per frame phase timings, written with T
+const char *SIM_PROFILE_FILE = "tick_timings.csv"; // per tick phase timings, written with T
+const char *CHECKPOINT_FILE = "checkpoint.bin"; // whole simulation state, written with K and read with L
+const char *TRAJECTORY_FILE = "trajectory.bin"; // boid positions of every frame, recorded between two presses of R
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
- * Purpose: Create a scene that contains birds that are flocking together.
+ * To put the force curve a_values into the panel's editor for function
+ * a_func, both the memoized values and the points of the curve.
+ */
+static void loadCurve(const int &a_func, const vector<float> &a_values) {
+    panel::funcs.curvesData().at(a_func).memoized = io::MemoizeFunction(a_values);
+
+    float incrementVal = 1.0 / a_values.size();
+    float xVal = 0.0f;
+    vector<ImVec2> curveValues;
+    for (float p : a_values) {
+        curveValues.push_back(ImVec2(xVal, p));
+        xVal += incrementVal;
+    }
+    panel::funcs.curvesData().at(a_func).curve.load(curveValues);
+}
+
+/**
+ * Purpose: Create a scene that contains birds that are flocking together,
+ * or with --replay file, play back a recording of one without simulating.
  *
  * @brief main
  * @return
  */
-int main(void) {
+int main(int argc, char *argv[]) {
     namespace p = panel; // use p in place of panel
+
+    TrajectoryPlayer player;
+    if (argc == 3 && string(argv[1]) == "--replay") {
+        if (!player.open(argv[2])) {
+            cout << player.getError() << endl;
+            return EXIT_FAILURE;
+        }
+        cout << "replaying " << player.getFrameCount() << " frames (" << player.getDuration() << " s) from "
+             << argv[2] << ", space plays and pauses" << endl;
+    } else if (argc > 1) {
+        cout << "usage: " << argv[0] << " [--replay recording]" << endl;
+        return EXIT_FAILURE;
+    }
     p::clear_color = ImVec4(0.0, 0.0, 0.0, 1.0);
 
     io::GLFWContext windows;
     auto window = windows.create(io::Window::dimensions{800, 600}, "CPSC 587 Assignment 4"); // generate window instance
-    window.enableVsync(true);
+    window.enableVsync(VSYNC);
 
     io::ImGuiContext ImGui(window); // create mGUI context for graph editor
 
@@ -72,46 +110,20 @@ int main(void) {
     view.camera.zoom(100.0f); // zoom camera out
     TurnTableControls controls(window, view.camera); // initialize controls for window
 
-    srand(static_cast<unsigned>(time(0))); // initialize the random number generator with a seed
-
-
+    /////////////////////////////////// READ CONTEXT FILE ////////////////////////////////////////
+    bool configLoaded = parseConfigFile(params, CONFIG_FILE);
+    Simulation sim(params);
 
+    if (configLoaded) {
 
-    /////////////////////////////////// READ CONTEXT FILE ////////////////////////////////////////
-    if (parseConfigFile(params, "configFiles/config.txt")) {
-
-        // generate boids with given information
-        if (params.numBoids > 0) {
-            for (unsigned int i = 0; i < params.numBoids; i++) {
-                // randomly assign a boid with a position and starting velocity of min
-                vec3f startPos = vec3f(randomFloatGenerator(-1.0, 1.0) * params.arenaRadius,
-                                       randomFloatGenerator(-1.0, 1.0) * params.arenaRadius,
-                                       randomFloatGenerator(-1.0, 1.0) * params.arenaRadius);
-                vec3f startVel = vec3f(randomFloatGenerator(-1.0, 1.0) * params.minVelocity,
-                                       randomFloatGenerator(-1.0, 1.0) * params.minVelocity,
-                                       randomFloatGenerator(-1.0, 1.0) * params.minVelocity);
-                params.boids->push_back(new Boid(i,
-                                                 params.boidMass,
-                                                 startPos,
-                                                 startVel,
-                                                 vec3f(0, 0, 0)));
-            }
-        }
+        // generate boids with given information, seeded from the clock
+        if (params.numBoids > 0)
+            sim.spawnBoids(static_cast<unsigned>(time(0)));
 
         // if true, parse into the memoized function and boids info
         if (params.graphValues->size() != 0) {
             params.boidFunc = p::funcs.create("y Value", params.graphValues->size()); // number of buckets for y value
-            p::funcs.curvesData().at(params.boidFunc).memoized = io::MemoizeFunction(*params.graphValues);
-
-            // update the curve to have the points read in
-            float incrementVal = 1.0 / params.graphValues->size();
-            float xVal = 0.0f;
-            vector<ImVec2> curveValues;
-            for (float p : *params.graphValues) {
-                curveValues.push_back(ImVec2(xVal, p));
-                xVal += incrementVal;
-            }
-            p::funcs.curvesData().at(params.boidFunc).curve.load(curveValues);
+            loadCurve(params.boidFunc, *params.graphValues); // update the curve to have the points read in
         }
     } else {
         // use default values
@@ -122,19 +134,21 @@ int main(void) {
     //////////////////////////////////// CREATE GEOMETRY /////////////////////////////////////////
 
     auto instancedBee = createInstancedRenderable(Mesh(Filename("../../models/bee.obj")),
-                                                  Phong(Colour(1., 1., 0.1529), LightPosition(100.f, 100.f, 100.f)));
+                                                  FramedPhong(Colour(1., 1., 0.1529), LightPosition(100.f, 100.f, 100.f),
+                                                              UpDirection(GRAVITY)));
 
 
 
     ///////////////////////////////////// CREATE OBSTACLES ///////////////////////////////////////
     // create a cylinder to fly around
-    vector<CylinderGeometry> *obstacles = new vector<CylinderGeometry>();
-
-    obstacles->push_back(Cylinder(Point1(0.0, 0.0, params.arenaRadius),
-                                  Point2(0.0, 0.0, -params.arenaRadius),
-                                  Radius(params.maxSearchRange - (params.maxSearchRange * 0.3))));
-
-    auto cylinder = createRenderable(obstacles->at(0),
+    sim.addObstacle({vec3f(0.0, 0.0, params.arenaRadius),
+                     vec3f(0.0, 0.0, -params.arenaRadius),
+                     params.maxSearchRange - (params.maxSearchRange * 0.3f)});
+
+    const CylinderObstacle &obstacle = sim.getObstacles().at(0);
+    auto cylinder = createRenderable(Cylinder(Point1(obstacle.p1),
+                                              Point2(obstacle.p2),
+                                              Radius(obstacle.radius)),
                                      Phong(Colour(1.0, 0.0, 0.0), LightPosition(100.f, 100.f, 100.f)));
 
 
@@ -152,14 +166,15 @@ int main(void) {
                 for (signed int i = 0; i < p::funcs.curvesData().at(params.boidFunc).memoized.bucketCount(); i++)
                     params.graphValues->push_back(datum[i]);
 
-                if (saveConfigFile(params, "configFiles/config.txt")) cout << "file succesfully saved" << endl;
+                if (saveConfigFile(params, CONFIG_FILE)) cout << "file succesfully saved" << endl;
                 else cout << "file write failed" << endl;
             }
         }) |
-        // pause simulation
-        io::Key(GLFW_KEY_SPACE, [](io::KeyboardEvent key) {
+        // pause simulation, or the replay
+        io::Key(GLFW_KEY_SPACE, [&player](io::KeyboardEvent key) {
             if (key.action == GLFW_RELEASE) {
-                PAUSED = !PAUSED;
+                if (player.isOpen()) player.setPaused(!player.isPaused());
+                else PAUSED = !PAUSED;
             }
         }) |
         // turn on obstacle mode
@@ -168,16 +183,137 @@ int main(void) {
                 OBSTACLE_MODE = !OBSTACLE_MODE;
                 if (OBSTACLE_MODE) cout << "Obstacle Mode Engaged" << endl;
             }
+        }) |
+        // the simulation keeps its own rate, vsync only limits the frames
+        io::Key(GLFW_KEY_V, [&window](io::KeyboardEvent key) {
+            if (key.action == GLFW_RELEASE) {
+                VSYNC = !VSYNC;
+                window.enableVsync(VSYNC);
+                cout << "vsync " << (VSYNC ? "on" : "off") << endl;
+            }
+        });
+
+
+
+    ///////////////////////////////// SIMULATION THREAD ////////////////////////////////////////
+    // sim is only touched through simThread from here on
+    SimulationThread simThread(sim);
+    TrajectoryRecorder recorder;
+    ConfigWatcher configWatcher;
+
+
+    ////////////////////////////////////// PROFILER //////////////////////////////////////////////
+    Profiler profiler;
+    const unsigned int PHASE_INSTANCES = profiler.addPhase("add instances");
+    const unsigned int PHASE_DRAW = profiler.addPhase("draw");
+    const unsigned int PHASE_PANEL = profiler.addPhase("panel");
+    p::profiler = &profiler;
+    p::profileFile = PROFILE_FILE;
+    p::simProfiler = player.isOpen() ? nullptr : &simThread.getProfiler();
+    p::simProfileFile = SIM_PROFILE_FILE;
+    p::simThread = player.isOpen() ? nullptr : &simThread;
+    p::player = player.isOpen() ? &player : nullptr;
+    if (player.isOpen()) p::showPanel = true; // for the replay controls
+
+    // trace the GL submission of the instanced draws as well
+    Tracer::setThreadName("main");
+    givr::drawZoneCallback = [](const char *a_name, bool a_begin) {
+        static unsigned long long start = 0;
+        if (a_begin) start = Tracer::isEnabled() ? Tracer::now() : 0;
+        else if (start != 0) Tracer::record(a_name, start, Tracer::now());
+    };
+
+    window.keyboardCommands() |
+        // dump the frame and tick timings
+        io::Key(GLFW_KEY_T, [&profiler, &simThread](io::KeyboardEvent key) {
+            if (key.action == GLFW_RELEASE) {
+                auto dump = [](const Profiler &a_profiler, const char *a_file) {
+                    if (a_profiler.getFrameCount() == 0) cout << "no timings for " << a_file << " yet, turn them on in the panel" << endl;
+                    else if (a_profiler.writeCSV(a_file)) cout << "timings written to " << a_file << endl;
+                    else cout << "could not write " << a_file << endl;
+                };
+                dump(profiler, PROFILE_FILE);
+                dump(simThread.getProfiler(), SIM_PROFILE_FILE);
+            }
+        }) |
+        // save or restore the whole simulation between two ticks
+        io::Key(GLFW_KEY_K, [&sim, &simThread, &player](io::KeyboardEvent key) {
+            if (key.action == GLFW_RELEASE && !player.isOpen()) {
+                string error;
+                simThread.stop();
+                if (Checkpoint::save(sim, CHECKPOINT_FILE, &error)) cout << "checkpoint written to " << CHECKPOINT_FILE << endl;
+                else cout << error << endl;
+                simThread.start();
+            }
+        }) |
+        io::Key(GLFW_KEY_L, [&sim, &simThread, &player, &configWatcher](io::KeyboardEvent key) {
+            if (key.action == GLFW_RELEASE && !player.isOpen()) {
+                Checkpoint checkpoint;
+                if (!checkpoint.open(CHECKPOINT_FILE)) {
+                    cout << checkpoint.getError() << endl;
+                    return;
+                }
+                simThread.stop();
+                checkpoint.restore(sim);
+
+                // the panel, recorder and config watcher carry on from the
+                // checkpoint's parameters and curve too, and a change handed
+                // to the simulation before the restore is dropped
+                int boidFunc = params.boidFunc;
+                checkpoint.getParameters(params);
+                params.boidFunc = boidFunc;
+                if (!params.graphValues->empty()) loadCurve(params.boidFunc, *params.graphValues);
+                simThread.setParameters(params);
+                if (configWatcher.isWatching()) configWatcher.start(CONFIG_FILE, params);
+                simThread.start();
+                cout << checkpoint.getBoidCount() << " boids restored from " << CHECKPOINT_FILE
+                     << " at substep " << checkpoint.getStepCount() << endl;
+            }
+        }) |
+        // record the frames shown to a file, or stop recording
+        io::Key(GLFW_KEY_R, [&recorder, &simThread, &player](io::KeyboardEvent key) {
+            if (key.action != GLFW_RELEASE || player.isOpen()) return;
+            if (recorder.isRecording()) {
+                bool written = recorder.stop();
+                cout << recorder.getFrameCount() << " frames" << (written ? " recorded to " : " could not all be written to ")
+                     << TRAJECTORY_FILE << ", " << recorder.getBytesPerBoidFrame() << " bytes per boid per frame";
+                if (recorder.getDroppedCount() > 0) cout << ", " << recorder.getDroppedCount() << " dropped";
+                cout << endl;
+            } else if (recorder.start(TRAJECTORY_FILE, params.arenaRadius, params.boidMass, simThread.getTickPeriod())) {
+                cout << "recording to " << TRAJECTORY_FILE << endl;
+            } else {
+                cout << "could not write " << TRAJECTORY_FILE << endl;
+            }
         });
 
 
+    // the simulation is left idle while replaying
+    if (!player.isOpen()) {
+        cout << "Running force calculations on " << sim.getThreadCount() << " threads ("
+             << pairKernelName(sim.getPairKernel()) << " pair kernel), "
+             << 1.0 / simThread.getTickPeriod() << " ticks per second" << endl;
+
+        const io::MemoizeFunction &startCurve = p::funcs.curvesData().at(params.boidFunc).memoized;
+        simThread.setForceCurve(startCurve.data(), startCurve.bucketCount());
+        simThread.start();
+
+        if (configWatcher.start(CONFIG_FILE, params)) cout << "watching " << CONFIG_FILE << " for changes" << endl;
+        else cout << configWatcher.getError() << endl;
+    }
+
 
     //----------------------------------------------------------------------------------------------
     // GRAPHICS LOOP
     //----------------------------------------------------------------------------------------------
     window.run([&](float) {
+        TraceZone frameZone("frame");
+        profiler.beginFrame();
+
         glfwPollEvents(); // wait for interrupts
-        p::menu(); // instatiate menu
+        {
+            ProfileScope scope(&profiler, PHASE_PANEL);
+            p::menu(); // instatiate menu
+        }
 
         auto color = p::clear_color; // menu colour clear
         glClearColor(color.x, color.y, color.z, color.w); // screen clear color
@@ -186,167 +322,74 @@ int main(void) {
         view.projection.updateAspectRatio(window.width(), window.height()); // update the view matrix
 
 
-        if (!PAUSED) {
-            for (unsigned int i = 0; i < INTEGRATION; i++) { // integrate multiple times
-
-
-
-                // go through each boid and calculate personal forces
-                for (Boid *b : *params.boids) {
-                    b->calculateBoundaryForce(params.arenaRadius, params.forceMultiplier);
-
-                    if (OBSTACLE_MODE) {
-                        // test for object collisions
-                        for (CylinderGeometry o : *obstacles) {
-                            vec3f cylinderOrigin = (o.p1() + o.p2()) * 0.5f; // get the midway vector
-
-                            vec3f nextPos = b->getPosition() + b->getVelocity() * DELTA_T; // look ahead
-                            vec3f currVel = b->getVelocity();
-                            vec2f testPos = vec2f(nextPos.x, nextPos.y) -
-                                            vec2f(cylinderOrigin.x, cylinderOrigin.y);
-                            vec2f testVel = vec2f(currVel.x, currVel.y);
-                            float r = o.radius() + (params.maxSearchRange * 0.3f);
-
-                            float A = dot(testVel, testVel);
-                            float B = 2 * dot(testVel, testPos);
-                            float C = dot(testPos, testPos) - (r * r);
-
-                            float descriminant = (B * B) - (4 * A * C);
-                            float denominator = 0.0f;
-                            float t = 0.0f, t1 = 0.0f, t2 = 0.0f;
-
-                            if (descriminant >= 0) { // one or more solutions
-                                if (descriminant == 0) {
-                                    t = -B / (2 * A);
-                                } else {
-                                    descriminant = sqrt(descriminant);
-                                    denominator = -B - descriminant;
-                                    if (denominator != 0) t1 = denominator / (2 * A);
-                                    denominator = -B + descriminant;
-                                    if (denominator != 0) t2 = denominator / (2 * A);
-
-                                    // take the larger of the smaller of the two
-                                    t = t1 < t2 ? t1 : t2;
-                                }
-                                // if collision detected, calculate force to apply to the boid
-                                if (t > 0.0) {
-                                    // plug back into x + tv to give point in 3d where it intersects
-                                    vec3f intersect = b->getPosition() + t * b->getVelocity(); // intersect point
-
-                                    // calculate normal and tangential force
-                                    vec3f resultant = vec3f(0.0f, 0.0f, 0.0f);
-                                    vec3f normal = vec3f(intersect.x, intersect.y, 0.0f) - vec3f(cylinderOrigin.x, cylinderOrigin.y, 0.0f);
-                                    normal = glm::normalize(normal);
-                                    resultant += normal * params.forceMultiplier;
-
-                                    vec3f tangent = b->getVelocity() - (glm::dot(b->getVelocity(), normal) * normal);
-                                    tangent = glm::normalize(tangent);
-                                    resultant += tangent * params.forceMultiplier;
-
-                                    b->addNetForce(resultant);
-                                }
-                            }
-                        }
-                    }
-
-
-
-
-
-                    // calculate boid to boid interactions
-                    for (Boid *o_b : *params.boids) // N^2 version
-                        if (b != o_b)
-                            if (o_b->getID() < b->getID()) {
-                                vec3f force(0, 0, 0);
-                                vec3f direction = o_b->getPosition() - b->getPosition();
-                                float dist = glm::length(direction);
-                                float evalResult = 0.0;
-                                direction = glm::normalize(direction);
-
-                                float avoid = params.avoidanceRange;
-                                float cohesion = params.cohesionRange;
-                                float max = params.maxSearchRange;
-                                float ratio = 0.0f;
-
-                                // boid / boid testing
-                                if (dist < avoid) { // withing avoidance range
-                                    ratio = (dist / avoid) * 0.333;
-                                    evalResult = p::funcs.evaluateFast(params.boidFunc, ratio);
-                                    force = evalResult * -direction * params.avoidanceMultiplier;
-                                } else if (dist < cohesion) { // withing cohesion range
-                                    ratio = (dist / cohesion) * 0.666;
-                                    evalResult = p::funcs.evaluateFast(params.boidFunc, ratio);
-                                    force = evalResult * (o_b->getVelocity() - b->getVelocity()) * params.cohesionMultiplier;
-                                } else if (dist < params.maxSearchRange) { // within gather range
-                                    ratio = (dist / max) * 1.0f;
-                                    evalResult = p::funcs.evaluateFast(params.boidFunc, ratio);
-                                    force = evalResult * direction * params.gatherMultiplier;
-                                } else { // at max range or greater
-                                    // ignore
-                                }
-
-                                // apply forces to each boid respectively
-                                b->addNetForce(force);
-                                o_b->addNetForce(-force);
-                            }
-                }
-
-                // go through each boid and update positions
-                for (Boid *b : *params.boids)
-                    b->updateBoidPosition(DELTA_T, params.minVelocity, params.maxVelocity);
+        // hand edits to the force curve from the panel over to the simulation
+        {
+            const io::MemoizeFunction &memoized = p::funcs.curvesData().at(params.boidFunc).memoized;
+            simThread.setForceCurve(memoized.data(), memoized.bucketCount());
+            simThread.setObstacleMode(OBSTACLE_MODE);
+            simThread.setPaused(PAUSED);
+        }
 
+        // parameters saved to the config file since the last frame, the
+        // simulation takes them all together before its next tick
+        {
+            vector<string> changed;
+            if (configWatcher.poll(params, changed)) {
+                simThread.setParameters(params);
+                cout << "config reloaded:";
+                for (const string &key : changed) cout << " " << key;
+                cout << endl;
             }
-
-
         }
 
-        // calculate the orientation of the boid
-        for (Boid *b : *params.boids) {
-            vec3f T = glm::normalize(b->getVelocity()); // tangent vector
-            vec3f B = glm::normalize(glm::cross(glm::normalize(GRAVITY + b->getLastForce()), T));
-            vec3f N = glm::normalize(glm::cross(B, T));
-            B = normalize(glm::cross(T, N)); // make orthonormal
-            vec3f p = b->getPosition();
-
-            mat4f model = {{B.x, B.y, B.z, 0.0},
-                           {N.x, N.y, N.z, 0.0},
-                           {T.x, T.y, T.z, 0.0},
-                           {p.x, p.y, p.z, 1.0}};
-            addInstance(instancedBee, model);
+        // hand the boid state between the two latest ticks (or the two
+        // recorded frames either side of the replay clock) over, the
+        // shader works out the orientation
+        {
+            ProfileScope scope(&profiler, PHASE_INSTANCES);
+            TraceZone zone("add instances");
+            const SimulationSnapshot *previous, *latest;
+            float alpha;
+            auto addBee = [&](vec3f a_p, vec3f a_v, vec3f a_F) { addInstance(instancedBee, a_p, a_v, a_F); };
+            if (player.isOpen()) {
+                player.update();
+                if (player.acquire(previous, latest, alpha)) {
+                    interpolateSnapshots(*previous, *latest, alpha, addBee);
+                    player.release();
+                }
+            } else if (simThread.acquire(previous, latest, alpha)) {
+                interpolateSnapshots(*previous, *latest, alpha, addBee);
+                recorder.record(*latest); // once per tick, the writing is on its own thread
+                simThread.release();
+            }
         }
 
 
         // RENDER
-        draw(instancedBee, view); // send data to GPU
-        // create the obstacle
-        if (OBSTACLE_MODE) draw(cylinder, view);
+        {
+            ProfileScope scope(&profiler, PHASE_DRAW);
+            TraceZone zone("draw");
+            draw(instancedBee, view); // send data to GPU
+            // create the obstacle
+            if (OBSTACLE_MODE) draw(cylinder, view);
+        }
 
-        io::renderDrawData(); // needed for rendering the panel
+        {
+            ProfileScope scope(&profiler, PHASE_PANEL);
+            io::renderDrawData(); // needed for rendering the panel
+        }
 
+        profiler.endFrame();
     });
 
 
+    configWatcher.stop();
+    simThread.stop();
+    recorder.stop(); // finishes the file with its index
+
     // reclaim memory
-    for (Boid *b : *params.boids)
-        delete b;
-    params.boids->clear();
-    delete params.boids;
     params.graphValues->clear();
     delete params.graphValues;
 
     exit(EXIT_SUCCESS);
 }
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// ADDITIONAL FUNCTIONS
-
-float randomFloatGenerator(const float &lower, const float &upper) {
-    return ( static_cast<float>(rand()) / static_cast<float>(RAND_MAX/(upper - lower)) ) + lower;
-}
-
-
-
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-
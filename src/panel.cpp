@@ -1,4 +1,6 @@
+#include <iostream>
 #include "panel.h"
+#include "tracer.h"
 
 namespace panel {
 
@@ -14,6 +16,79 @@ float yRange[2] = {0, +10};
 bool addBall = false;
 int ballCount = 1.f;
 
+Profiler *profiler = nullptr;
+const char *profileFile = "";
+Profiler *simProfiler = nullptr;
+const char *simProfileFile = "";
+SimulationThread *simThread = nullptr;
+TrajectoryPlayer *player = nullptr;
+const char *traceFile = "boids_trace.json";
+
+void profilerSection(Profiler *timings, const char *file, const char *id) {
+  using namespace ImGui;
+
+  PushID(id);
+  bool enabled = timings->isEnabled();
+  if (Checkbox("time phases", &enabled))
+    timings->setEnabled(enabled);
+  Text("%u %s kept, T writes them to %s", timings->getFrameCount(), id, file);
+
+  Columns(4, "phases");
+  Text("phase"); NextColumn();
+  Text("min ms"); NextColumn();
+  Text("avg ms"); NextColumn();
+  Text("p99 ms"); NextColumn();
+  Separator();
+  for (unsigned int p = 0; p < timings->getPhaseCount(); p++) {
+    PhaseStats stats = timings->getStats(p);
+    Text("%s", timings->getPhaseName(p).c_str()); NextColumn();
+    Text("%.3f", stats.min); NextColumn();
+    Text("%.3f", stats.avg); NextColumn();
+    Text("%.3f", stats.p99); NextColumn();
+  }
+  Columns(1);
+  PopID();
+}
+
+void traceSection() {
+  using namespace ImGui;
+
+  bool recording = Tracer::isEnabled();
+  if (Checkbox("record trace", &recording))
+    Tracer::setEnabled(recording);
+  SameLine();
+  if (Button("save trace")) {
+    Tracer::setEnabled(false);
+    if (Tracer::write(traceFile))
+      std::cout << "trace written to " << traceFile << std::endl;
+    else
+      std::cout << "could not write " << traceFile << std::endl;
+  }
+  Text("%lu zones (%lu dropped), open %s in ui.perfetto.dev",
+       Tracer::getEventCount(), Tracer::getDroppedCount(), traceFile);
+}
+
+void replaySection() {
+  using namespace ImGui;
+
+  float time = player->getTime();
+  if (SliderFloat("time", &time, 0.0f, player->getDuration(), "%.2f s"))
+    player->setTime(time);
+
+  if (Button(player->isPaused() ? "play" : "pause"))
+    player->setPaused(!player->isPaused());
+  SameLine();
+  if (Button("rewind"))
+    player->setTime(0.0);
+  SameLine();
+  float speed = player->getSpeed();
+  if (SliderFloat("speed", &speed, 0.05f, 16.0f, "%.2fx", 3.0f))
+    player->setSpeed(speed);
+
+  Text("frame %lu of %lu, %.2f ms to decode", player->getFrame() + 1, player->getFrameCount(),
+       player->getDecodeTime());
+}
+
 void menu() {
   using namespace ImGui;
 
@@ -52,6 +127,29 @@ void menu() {
     Text("Application average %.3f ms/frame (%.1f FPS)",
          1000.0f / GetIO().Framerate, GetIO().Framerate);
 
+    // Playback of a recording in place of the simulation
+    if (player != nullptr && CollapsingHeader("Replay", ImGuiTreeNodeFlags_DefaultOpen))
+      replaySection();
+
+    // Simulation rate, it runs on its own thread
+    if (simThread != nullptr) {
+      Text("Simulation %.1f ticks/s (target %.1f)%s", simThread->getTickRate(),
+           1.0 / simThread->getTickPeriod(), simThread->isPaused() ? ", paused" : "");
+      double average = simThread->getAverageSubsteps();
+      Text("Substeps %u last, %.2f avg (%.1f%% saved against %u)", simThread->getLastSubsteps(), average,
+           100.0 * (1.0 - average / simThread->getSubsteps()), simThread->getSubsteps());
+    }
+
+    // Per phase timings
+    if (profiler != nullptr && CollapsingHeader("Profiler (frames)"))
+      profilerSection(profiler, profileFile, "frames");
+    if (simProfiler != nullptr && CollapsingHeader("Profiler (simulation ticks)"))
+      profilerSection(simProfiler, simProfileFile, "ticks");
+
+    // Chrome trace of the simulation and render threads
+    if (CollapsingHeader("Trace"))
+      traceSection();
+
     End();
   }
   io::EndFrame();
@@ -6,6 +6,9 @@
 
 #include "curve_gallery.h"
 #include "io.h"
+#include "profiler.h"
+#include "simulationthread.h"
+#include "trajectoryplayer.h"
 
 namespace panel {
 
@@ -24,6 +27,14 @@ extern float yRange[2];
 extern bool addBall;
 extern int ballCount;
 
+extern Profiler *profiler; // phase timings to show, may be null
+extern const char *profileFile; // where the timings get dumped
+extern Profiler *simProfiler; // same for the simulation ticks
+extern const char *simProfileFile;
+extern SimulationThread *simThread; // for its tick rate, may be null
+extern TrajectoryPlayer *player; // the recording being replayed, may be null
+extern const char *traceFile; // where a recorded trace gets saved
+
 void menu();
 
 } // namespace panel